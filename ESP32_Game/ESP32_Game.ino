@@ -3,50 +3,53 @@
 #include <Adafruit_ST7735.h>
 #include <SPI.h>
 #include <EEPROM.h>
+#include "config.h"
+#include "displaybackend.h"
+#include "dmabackend.h"
+#include "framebuffer.h"
+#include "frameprofiler.h"
+#include "game.h"
+#include "gameloop.h"
 #include "gamemenu.h"
+#include "gameregistry.h"
 #include "inputhandler.h"
-#include "spaceinvador.h"
-#include "flappybird.h"
-#include "snakegame.h"
-#include "breakout.h"
-// Pin definitions for TFT display
-#define TFT_CS D0 // Chip Select
-#define TFT_RST D1 // Reset
-#define TFT_DC D2 // Data/Command
-#define TFT_MOSI D3
-#define TFT_SCLK D4
-#define TFT_LED D5
-
-// Joystick pins
-#define X_PIN 5 // Analog pin A0
-#define Y_PIN 4 // Analog pin A1
-#define Button_PIN D10
-#define Vibrationmotor_PIN D9
+#include "logger.h"
+#include "rendertask.h"
+#include "telemetry.h"
+#include "scheduler.h"
 
 // Initialize TFT display
 // Increase SPI clock speed (check your display's specs for maximum supported speed!)
 Adafruit_ST7735 tft = Adafruit_ST7735(TFT_CS, TFT_DC, TFT_MOSI, TFT_SCLK, TFT_RST);
 
-// Game constants
-#define SCREEN_WIDTH 128
-#define SCREEN_HEIGHT 128
-#define PLAYER_WIDTH 11
-#define PLAYER_HEIGHT 8
-#define ALIEN_ROWS 3
-#define ALIEN_COLS 6
-#define ALIEN_WIDTH 8
-#define ALIEN_HEIGHT 8
-#define ALIEN_SPACING_X 12
-#define ALIEN_SPACING_Y 12
-#define BULLET_WIDTH 2
-#define BULLET_HEIGHT 5
-#define MAX_BULLETS 3
-#define MAX_ALIEN_BULLETS 2
-#define PLAYER_SPEED 2
-#define BULLET_SPEED 3
-#define SHIELD_COUNT 3
-#define SHIELD_WIDTH 16
-#define SHIELD_HEIGHT 8
+// Blocking writes through the Adafruit driver unless DMA is enabled and starts up
+GfxBackend gfxBackend(tft);
+#if DISPLAY_DMA
+DmaBackend dmaBackend(tft, TFT_MOSI, TFT_SCLK, TFT_CS, TFT_DC);
+#endif
+
+// Off-screen canvas every game draws into, flushed once per loop
+FrameBuffer frameBuffer(gfxBackend);
+
+#if DUAL_CORE_RENDER
+RenderTask renderTask; // Owns the SPI bus once started
+#endif
+
+// Games simulate in fixed SIM_STEP_MS steps; rendering runs once per loop
+FixedStepLoop gameLoop(SIM_STEP_MS, MAX_CATCH_UP_STEPS);
+
+#if FRAME_PROFILE
+FrameProfiler profiler(frameBuffer, gameLoop.stats(), Serial);
+#endif
+
+#if TELEMETRY_ENABLED
+Telemetry telemetry(Serial, 20); // At most 50 frames per second per channel
+
+struct InputSample {
+  int16_t x, y;
+  uint8_t buttons; // bit 0 held, bit 1 pressed, bit 2 released
+};
+#endif
 
 // Colors
 #define BLACK 0x0000
@@ -54,20 +57,17 @@ Adafruit_ST7735 tft = Adafruit_ST7735(TFT_CS, TFT_DC, TFT_MOSI, TFT_SCLK, TFT_RS
 #define GREEN 0x07E0
 #define RED 0xF800
 
-// Game state
-String gameState = "menu";
+// Top-level console state
+enum class ConsoleState { MENU, GAME };
+ConsoleState consoleState = ConsoleState::MENU;
+Game *activeGame = nullptr;
 
-
-// Game instances
+// Input and menu; the games themselves live in gameregistry.h
 InputHandler inputHandler(Button_PIN, X_PIN, Y_PIN);
-GameMenu gameMenu(tft, inputHandler);
-SpaceInvador spaceInvador(tft, Button_PIN, Vibrationmotor_PIN, X_PIN, Y_PIN);
-FlappyBird flappyBird(tft, Button_PIN, Vibrationmotor_PIN, X_PIN, Y_PIN);
-SnakeGame snakeGame(&tft, &inputHandler);
-Breakout breakoutGame(tft, Button_PIN, Vibrationmotor_PIN, X_PIN, Y_PIN);
+GameMenu gameMenu(frameBuffer, inputHandler);
 
 void setup() {
-  Serial.begin(9600);
+  Serial.begin(115200);
   
   // Initialize display
   // You can try to set the SPI frequency here (in Hz)
@@ -77,6 +77,15 @@ void setup() {
   SPI.beginTransaction(SPISettings(40000000, MSBFIRST, SPI_MODE0));
   tft.fillScreen(BLACK);
   
+#if DISPLAY_DMA
+  // The panel is initialized; hand its pins to the SPI peripheral
+  if (dmaBackend.begin()) {
+    frameBuffer.setBackend(dmaBackend);
+  } else {
+    LOG_ERROR(LOG_MODULE_MAIN, "DMA flush unavailable, using blocking writes");
+  }
+#endif
+  
   // Initialize LED backlight
   pinMode(TFT_LED, OUTPUT);
   digitalWrite(TFT_LED, HIGH);
@@ -84,102 +93,96 @@ void setup() {
   // Initialize controls
   pinMode(Button_PIN, INPUT_PULLUP);
   pinMode(Vibrationmotor_PIN, OUTPUT);
+  inputHandler.begin();
+  
+#if DUAL_CORE_RENDER
+  renderTask.begin(frameBuffer.getBackend());
+#endif
   
   // Initialize game menu
   gameMenu.init();
+  
+  // Don't count the time spent in setup() as simulation debt
+  gameLoop.reset(millis());
 }
 
-void loop() {
+void launchGame(int index) {
+  LOG_INFO(LOG_MODULE_MAIN, "Launching game ", index);
+  frameBuffer.fillScreen(BLACK);
+  
+  activeGame = GAME_REGISTRY[index].create(frameBuffer, inputHandler);
+  activeGame->init();
+  consoleState = ConsoleState::GAME;
+  
+  gameMenu.shouldLaunchGame = false;
+  gameMenu.selectedItem = 0; // Reset menu selection
+  inputHandler.reset(); // Clear all input states
+}
+
+void returnToMenu() {
+  consoleState = ConsoleState::MENU;
+  activeGame = nullptr;
+  inputHandler.buttonPressed = false; // Don't let the same press launch a game
+  gameMenu.init();
+}
+
+// One simulation step: input is sampled per step so edges land on exactly one
+void updateConsole(unsigned long dt) {
   // Update input handler
   inputHandler.update();
   
-  // Handle button press for menu navigation
-  if (inputHandler.buttonPressed) {
-    Serial.println("Button press detected in main loop");
-    if (gameState == "menu") {
-      Serial.println("Menu state detected");
-      gameMenu.draw(); // Update menu to process button press
-      
+  switch (consoleState) {
+    case ConsoleState::MENU:
+      // Handles joystick navigation and the launch button
+      gameMenu.draw();
       if (gameMenu.shouldLaunchGame) {
-        Serial.println("Launching game " + String(gameMenu.currentGameIndex));
-        gameState = "game";
-        tft.fillScreen(BLACK);
-        
-        // Launch the selected game
-        if (gameMenu.currentGameIndex == 0) {
-          // Space Invaders
-          spaceInvador.init();
-        } else if (gameMenu.currentGameIndex == 1) {
-          // Flappy Bird
-          flappyBird.init();
-        } else if (gameMenu.currentGameIndex == 2) {
-          // Snake Game
-          snakeGame.init();
-        } else if (gameMenu.currentGameIndex == 3) {
-          // Breakout Game
-          breakoutGame.init();
-        }
-        
-        gameMenu.shouldLaunchGame = false;
-        gameMenu.selectedItem = 0; // Reset menu selection
-        inputHandler.reset(); // Clear all input states
-        return; // Exit early to prevent multiple state changes
+        launchGame(gameMenu.currentGameIndex);
       }
-    } else if (gameState == "game") {
-      // Check if any game is over and return to menu
-      if ((gameMenu.currentGameIndex == 0 && spaceInvador.getState() == SpaceInvador::GAME_OVER) ||
-          (gameMenu.currentGameIndex == 1 && flappyBird.getState() == FlappyBird::GAME_OVER)) {
-        gameState = "menu";
-        tft.fillScreen(BLACK); // Clear screen before returning to menu
-        inputHandler.buttonPressed = false; // Reset button state
-        return; // Exit early to prevent multiple state changes
+      break;
+      
+    case ConsoleState::GAME:
+      // Games handle their own game over input and ask for the menu
+      activeGame->update(dt, inputHandler);
+      if (activeGame->wantsMenu()) {
+        returnToMenu();
       }
-    }
+      break;
   }
+}
+
+void loop() {
+#if FRAME_PROFILE
+  profiler.beginFrame();
+#endif
+
+  // Fire due timers (vibration pulses)
+  scheduler.run();
   
-  if (gameState == "menu") {
-    // Handle menu navigation with joystick
-    if (inputHandler.up) {
-      gameMenu.selectedItem = max(0, gameMenu.selectedItem - 1);
-    } else if (inputHandler.down) {
-      gameMenu.selectedItem = min(MAX_MENU_ITEMS - 1, gameMenu.selectedItem + 1);
-    }
-    
-    gameMenu.draw();
-  } else if (gameState == "game") {
-    // Update active game
-    bool buttonPressed = digitalRead(Button_PIN) == HIGH;
-    bool buttonReleased = digitalRead(Button_PIN) == LOW;
-    
-    // Update the appropriate game based on which one is active
-    if (gameMenu.currentGameIndex == 0) {
-      // Update Space Invaders game
-      spaceInvador.update(buttonPressed, buttonReleased);
-    } else if (gameMenu.currentGameIndex == 1) {
-      // Update Flappy Bird game
-      flappyBird.update(buttonPressed, buttonReleased);
-    } else if (gameMenu.currentGameIndex == 2) {
-      // Update Snake game
-      snakeGame.update();
-      if (snakeGame.isGameOver()) {
-        if (buttonPressed) {
-          gameState = "menu";
-          gameMenu.init();
-        }
-      }
-    } else if (gameMenu.currentGameIndex == 3) {
-      // Update Breakout game
-      breakoutGame.update(buttonPressed, buttonReleased);
-      breakoutGame.render();
-      if (breakoutGame.isGameOver()) {
-        if (buttonPressed) {
-          gameState = "menu";
-          gameMenu.init();
-        }
-      }
-    }
-    
-    // Game over handling is done in each game's respective update method
-    // and checked in the button press handler above
+  int steps = gameLoop.advance(millis());
+  for (int i = 0; i < steps; i++) {
+    updateConsole(SIM_STEP_MS);
   }
-}
+  if (consoleState == ConsoleState::GAME) {
+    activeGame->render(gameLoop.alpha());
+  }
+
+#if TELEMETRY_ENABLED
+  InputSample sample;
+  sample.x = inputHandler.xValue;
+  sample.y = inputHandler.yValue;
+  sample.buttons = (inputHandler.buttonHeld ? 1 : 0) | (inputHandler.buttonPressed ? 2 : 0) |
+                   (inputHandler.buttonReleased ? 4 : 0);
+  telemetry.send(TELEMETRY_INPUT, &sample, sizeof(sample));
+#endif
+  
+  // Push everything drawn this iteration to the display
+#if DUAL_CORE_RENDER
+  renderTask.submit(frameBuffer);
+#else
+  frameBuffer.flush();
+#endif
+
+#if FRAME_PROFILE
+  profiler.endFrame(consoleState == ConsoleState::MENU ? "menu" : GAME_REGISTRY[gameMenu.currentGameIndex].name);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "ballpool.h"
+
+BallPool::BallPool() : _count(0), shownCount(0) {}
+
+bool BallPool::spawn(Fixed8 bx, Fixed8 by, Fixed8 bvx, Fixed8 bvy) {
+  if (_count == MAX_BALLS) return false;
+  x[_count] = prevX[_count] = bx;
+  y[_count] = prevY[_count] = by;
+  vx[_count] = bvx;
+  vy[_count] = bvy;
+  _count++;
+  return true;
+}
+
+void BallPool::release(uint8_t index) {
+  _count--;
+  x[index] = x[_count];
+  y[index] = y[_count];
+  prevX[index] = prevX[_count];
+  prevY[index] = prevY[_count];
+  vx[index] = vx[_count];
+  vy[index] = vy[_count];
+}
+
+uint8_t BallPool::advance(BrickField &bricks, const Rect &paddle, Fixed8 speed, int16_t &hitX, int16_t &hitY) {
+  // Balls whose whole move stays clear of the walls, the brick rows and
+  // the paddle row can't hit anything
+  const Fixed8 bricksBottom(BRICK_ORIGIN_Y + BRICK_ROWS * BRICK_HEIGHT);
+  const Fixed8 right(FRAMEBUFFER_WIDTH - BALL_SIZE), paddleTop(paddle.y - BALL_SIZE);
+  for (int i = 0; i < _count; i++) {
+    Fixed8 dx = vx[i] < 0 ? -vx[i] : vx[i];
+    Fixed8 dy = vy[i] < 0 ? -vy[i] : vy[i];
+    near[i] = (x[i] - dx < 0) | (x[i] + dx > right) |
+              (y[i] - dy < bricksBottom) | (y[i] + dy > paddleTop);
+  }
+  for (int i = 0; i < _count; i++) {
+    prevX[i] = x[i];
+    prevY[i] = y[i];
+  }
+  for (int i = 0; i < _count; i++) {
+    x[i] += near[i] ? 0 : vx[i];
+    y[i] += near[i] ? 0 : vy[i];
+  }
+
+  uint8_t result = 0;
+  for (int i = 0; i < _count; i++) {
+    if (!near[i]) continue;
+    Ball ball = get(i);
+    uint8_t hit = bricks.sweep(ball, paddle, speed);
+    if (hit & BrickField::HIT_BRICK) {
+      hitX = ball.x.toInt();
+      hitY = ball.y.toInt();
+    }
+    result |= hit;
+    x[i] = ball.x;
+    y[i] = ball.y;
+    vx[i] = ball.vx;
+    vy[i] = ball.vy;
+  }
+
+  // Drop balls that fell past the paddle; release() moves the last ball
+  // into the freed slot, so look at this index again
+  for (int i = 0; i < _count;) {
+    if (y[i] >= Fixed8(FRAMEBUFFER_HEIGHT)) {
+      release(i);
+    } else {
+      i++;
+    }
+  }
+  return result;
+}
+
+void BallPool::split() {
+  uint8_t parents = _count;
+  for (int i = 0; i < parents; i++) {
+    spawn(x[i], y[i], -vx[i], vy[i]);
+    spawn(x[i], y[i], vx[i], -vy[i]);
+  }
+}
+
+void BallPool::draw(Adafruit_GFX &gfx, uint16_t color, uint16_t background, Fixed8 alpha) {
+  for (int i = 0; i < shownCount; i++) {
+    gfx.fillRect(shownX[i], shownY[i], BALL_SIZE, BALL_SIZE, background);
+  }
+  for (int i = 0; i < _count; i++) {
+    shownX[i] = (prevX[i] + (x[i] - prevX[i]) * alpha).toInt();
+    shownY[i] = (prevY[i] + (y[i] - prevY[i]) * alpha).toInt();
+    gfx.fillRect(shownX[i], shownY[i], BALL_SIZE, BALL_SIZE, color);
+  }
+  shownCount = _count;
+}
@@ -0,0 +1,55 @@
+#ifndef BALLPOOL_H
+#define BALLPOOL_H
+
+#include <Adafruit_GFX.h>
+#include "brickfield.h"
+
+#define MAX_BALLS 64
+
+// Fixed-capacity set of Breakout balls, stored as one array per field and
+// kept packed at the front like ObjectPool. advance() first moves every
+// ball that can't touch a wall, brick or the paddle this step with plain
+// adds over the arrays, which the compiler can vectorize. Only the few
+// balls near something go through BrickField::sweep. Positions from the
+// step before are kept so draw() can put balls between steps.
+class BallPool {
+public:
+  BallPool();
+
+  // Add a ball; false when the pool is full
+  bool spawn(Fixed8 x, Fixed8 y, Fixed8 vx, Fixed8 vy);
+  void clear() { _count = 0; }
+  uint8_t count() const { return _count; }
+
+  Ball get(uint8_t index) const { return { x[index], y[index], vx[index], vy[index] }; }
+
+  // Move every ball one step; paddle bounces leave at `speed`. Balls that
+  // fall off the bottom are removed. Returns the BrickField::SweepResult
+  // bits of all balls together, and where the last ball to break a brick
+  // was in hitX/hitY.
+  uint8_t advance(BrickField &bricks, const Rect &paddle, Fixed8 speed, int16_t &hitX, int16_t &hitY);
+
+  // Give every ball two companions heading off at mirrored angles, as far
+  // as the pool has room
+  void split();
+
+  // Erase every ball drawn last time, then draw them all `alpha` of the
+  // way from their previous position to the current one
+  void draw(Adafruit_GFX &gfx, uint16_t color, uint16_t background, Fixed8 alpha = Fixed8(1));
+  // Forget what is on screen, e.g. after it was cleared
+  void forgetDrawn() { shownCount = 0; }
+
+private:
+  void release(uint8_t index);
+
+  Fixed8 x[MAX_BALLS], y[MAX_BALLS];
+  Fixed8 vx[MAX_BALLS], vy[MAX_BALLS];
+  Fixed8 prevX[MAX_BALLS], prevY[MAX_BALLS];
+  uint8_t near[MAX_BALLS]; // Needs a swept move this step
+  uint8_t _count;
+
+  int16_t shownX[MAX_BALLS], shownY[MAX_BALLS];
+  uint8_t shownCount;
+};
+
+#endif
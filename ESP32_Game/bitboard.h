@@ -0,0 +1,66 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+#include <string.h>
+
+// One bit per cell of a grid, for occupancy tests in O(1).
+// count() is kept up to date by set() and clear(), and selectFree() finds
+// the n-th empty cell a word at a time with popcount, so picking a random
+// free cell doesn't degrade as the board fills up.
+template <int Cells>
+class Bitboard {
+public:
+  static const int WORDS = (Cells + 31) / 32;
+
+  Bitboard() { reset(); }
+
+  void reset() {
+    memset(_words, 0, sizeof(_words));
+    _count = 0;
+  }
+
+  bool test(int cell) const { return (_words[cell >> 5] >> (cell & 31)) & 1; }
+
+  void set(int cell) {
+    uint32_t bit = 1u << (cell & 31);
+    if (!(_words[cell >> 5] & bit)) _count++;
+    _words[cell >> 5] |= bit;
+  }
+
+  void clear(int cell) {
+    uint32_t bit = 1u << (cell & 31);
+    if (_words[cell >> 5] & bit) _count--;
+    _words[cell >> 5] &= ~bit;
+  }
+
+  int count() const { return _count; }
+  int freeCount() const { return Cells - _count; }
+
+  // Index of the n-th free cell (0-based), or -1 if there are fewer
+  int selectFree(int n) const {
+    for (int w = 0; w < WORDS; w++) {
+      uint32_t free = ~_words[w] & validBits(w);
+      int inWord = __builtin_popcount(free);
+      if (n >= inWord) {
+        n -= inWord;
+        continue;
+      }
+      while (n--) free &= free - 1; // Drop the lowest free cells
+      return (w << 5) + __builtin_ctz(free);
+    }
+    return -1;
+  }
+
+private:
+  // Cells past the end of the grid in the last word never count as free
+  static uint32_t validBits(int word) {
+    int bits = Cells - (word << 5);
+    return bits >= 32 ? 0xFFFFFFFFu : (1u << bits) - 1;
+  }
+
+  uint32_t _words[WORDS];
+  int _count;
+};
+
+#endif
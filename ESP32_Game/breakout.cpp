@@ -1,76 +1,81 @@
 #include "breakout.h"
 #include <Arduino.h>
 
-Breakout::Breakout(Adafruit_ST7735 &tft, uint8_t buttonPin, uint8_t motorPin, int xPin, int yPin) 
-    : tft(tft), buttonPin(buttonPin), motorPin(motorPin), xPin(xPin), yPin(yPin), state(INTRO) {}
+Breakout::Breakout(FrameBuffer &tft) 
+    : tft(tft), state(INTRO), menuRequested(false) {}
 
 void Breakout::init() {
     state = INTRO;
+    menuRequested = false;
     resetGame();
 }
 
-void Breakout::update(bool buttonPressed, bool buttonReleased) {
-    static unsigned long lastFrameTime = 0;
-    const unsigned long frameInterval = 1000 / 60; // 60 FPS
-    
-    unsigned long currentTime = millis();
-    if (currentTime - lastFrameTime < frameInterval) {
-        return; // Skip frame if not enough time has passed
-    }
-    lastFrameTime = currentTime;
+void Breakout::update(unsigned long, InputHandler &input) {
+    bool buttonPressed = input.buttonPressed;
     
     switch(state) {
         case INTRO:
             if(buttonPressed) {
                 state = PLAYING;
+                fieldDrawn = false;
             }
             break;
             
         case PLAYING:
-            // Paddle movement
-            if(analogRead(xPin) < 1600) paddleX = max(0, paddleX - 2);
-            if(analogRead(xPin) > 1700) paddleX = min(tft.width() - 20, paddleX + 2);
-            
-            // Ball movement
-            ballX += ballSpeedX;
-            ballY += ballSpeedY;
+            // Paddle speed follows how far the stick is pushed
+            prevPaddleX = paddleX;
+            paddleX += Fixed8::fromRaw(PADDLE_MAX_SPEED * Fixed8::ONE * input.xAxis / JOYSTICK_AXIS_MAX);
+            if(paddleX < 0) paddleX = 0;
+            if(paddleX > Fixed8(tft.width() - 20)) paddleX = Fixed8(tft.width() - 20);
             
-            // Ball collision with walls
-            if(ballX <= 0 || ballX >= tft.width() - 2) ballSpeedX = -ballSpeedX;
-            if(ballY <= 0) ballSpeedY = -ballSpeedY;
-            
-            // Ball collision with paddle
-            if(ballY >= tft.height() - 10 && 
-               ballX >= paddleX && ballX <= paddleX + 20) {
-                ballSpeedY = -ballSpeedY;
+            // Ball movement, bouncing off walls, bricks and the paddle
+            {
+                int16_t hitX, hitY;
+                uint8_t hits = balls.advance(bricks, paddleRect(), ballSpeed, hitX, hitY);
+                if((hits & BrickField::HIT_BRICK) && random(100) < POWERUP_CHANCE) {
+                    // Drop from below the bricks so it never falls across them
+                    PowerUp *drop = powerUps.spawn();
+                    if(drop) *drop = { hitX, BRICK_ORIGIN_Y + BRICK_ROWS * BRICK_HEIGHT };
+                }
             }
+            updatePowerUps();
             
-            // Ball out of bounds (game over)
-            if(ballY >= tft.height()) {
+            // Last ball out of bounds (game over)
+            if(balls.count() == 0) {
                 state = GAME_OVER;
+                gameOverDrawn = false;
+                gameOverInput.reset();
             }
             
-            // Brick collision detection would go here
+            // A cleared field comes back for another, faster round
+            if(bricks.isCleared()) {
+                bricks.fill();
+                fieldDrawn = false;
+                ballSpeed = min(ballSpeed + Fixed8::fromFloat(BALL_SPEED_STEP), Fixed8::fromFloat(BALL_MAX_SPEED));
+            }
             break;
             
         case GAME_OVER:
-            if(buttonPressed) {
-                state = INTRO;
-                resetGame();
+            switch(gameOverInput.update(input)) {
+                case GameOverInput::RESTART:
+                    state = INTRO;
+                    introDrawn = false;
+                    resetGame();
+                    break;
+                case GameOverInput::MENU:
+                    menuRequested = true;
+                    break;
+                case GameOverInput::NONE:
+                    break;
             }
             break;
     }
 }
 
-void Breakout::render() {
-    static unsigned long lastRenderTime = 0;
-    const unsigned long renderInterval = 1000 / 60; // 60 FPS
-    
-    unsigned long currentTime = millis();
-    if (currentTime - lastRenderTime < renderInterval) {
-        return; // Skip render if not enough time has passed
-    }
-    lastRenderTime = currentTime;
+// Ball and paddle are drawn between their last two steps, so motion stays
+// smooth whatever the frame rate
+void Breakout::render(Fixed8 alpha) {
+    int shownPaddleX;
     
     switch(state) {
         case INTRO:
@@ -81,24 +86,31 @@ void Breakout::render() {
             break;
             
         case PLAYING:
-            // Clear previous ball position
-            tft.fillRect(lastBallX, lastBallY, 2, 2, ST7735_BLACK);
+            // Bricks are drawn once, then only erased as they break
+            if(!fieldDrawn) {
+                tft.fillScreen(ST7735_BLACK);
+                bricks.draw(tft);
+                balls.forgetDrawn();
+                shownPowerUpCount = 0;
+                fieldDrawn = true;
+            } else {
+                bricks.drawChanges(tft);
+            }
+            
+            drawPowerUps();
             
             // Clear previous paddle position
             tft.fillRect(lastPaddleX, tft.height() - 8, 20, 1, ST7735_BLACK);
             
             // Draw new paddle position
-            tft.fillRect(paddleX, tft.height() - 8, 20, 1, ST7735_WHITE);
+            shownPaddleX = (prevPaddleX + (paddleX - prevPaddleX) * alpha).toInt();
+            tft.fillRect(shownPaddleX, tft.height() - 8, 20, 1, ST7735_WHITE);
             
-            // Draw new ball position
-            tft.fillRect(ballX, ballY, 2, 2, ST7735_WHITE);
+            // Erase and redraw all balls in one pass
+            balls.draw(tft, ST7735_WHITE, ST7735_BLACK, alpha);
             
             // Store current positions for next frame
-            lastPaddleX = paddleX;
-            lastBallX = ballX;
-            lastBallY = ballY;
-            
-            // Draw bricks would go here
+            lastPaddleX = shownPaddleX;
             break;
             
         case GAME_OVER:
@@ -110,8 +122,36 @@ void Breakout::render() {
     }
 }
 
-void Breakout::renderPixel(int x, int y, uint16_t color) {
-    tft.drawPixel(x, y, color);
+Rect Breakout::paddleRect() const {
+    return { (int16_t)paddleX.toInt(), (int16_t)(tft.height() - 8), 20, 1 };
+}
+
+// Power-ups fall a pixel per step; catching one splits every ball
+void Breakout::updatePowerUps() {
+    Rect paddle = paddleRect();
+    for(uint8_t i = 0; i < powerUps.count();) {
+        PowerUp &p = powerUps[i];
+        p.y++;
+        bool caught = p.y + POWERUP_SIZE > paddle.y && p.y <= paddle.y &&
+                      p.x + POWERUP_SIZE > paddle.x && p.x < paddle.x + paddle.w;
+        if(caught) balls.split();
+        if(caught || p.y >= tft.height()) {
+            powerUps.release(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void Breakout::drawPowerUps() {
+    for(uint8_t i = 0; i < shownPowerUpCount; i++) {
+        tft.fillRect(shownPowerUps[i].x, shownPowerUps[i].y, POWERUP_SIZE, POWERUP_SIZE, ST7735_BLACK);
+    }
+    for(uint8_t i = 0; i < powerUps.count(); i++) {
+        tft.fillRect(powerUps[i].x, powerUps[i].y, POWERUP_SIZE, POWERUP_SIZE, ST7735_GREEN);
+        shownPowerUps[i] = powerUps[i];
+    }
+    shownPowerUpCount = powerUps.count();
 }
 
 void Breakout::renderIntro() {
@@ -152,23 +192,24 @@ void Breakout::renderGameOver() {
     tft.setTextColor(ST7735_BLACK);
     tft.setTextSize(1);
     tft.print("TRY AGAIN");
+    
+    tft.setCursor(34, 100);
+    tft.setTextColor(ST7735_WHITE);
+    tft.print("HOLD: MENU");
 }
 
-bool Breakout::isGameOver() {
-    return state == GAME_OVER;
+bool Breakout::wantsMenu() const {
+    return menuRequested;
 }
 
 void Breakout::resetGame() {
-    paddleX = tft.width() / 2 - 10;
-    ballX = tft.width() / 2;
-    ballY = tft.height() / 2;
-    ballSpeedX = 1;
-    ballSpeedY = -1;
+    paddleX = prevPaddleX = Fixed8(tft.width() / 2 - 10);
+    ballSpeed = Fixed8::fromFloat(BALL_START_SPEED);
     
-    // Initialize bricks
-    for(int i = 0; i < 5; i++) {
-        for(int j = 0; j < 10; j++) {
-            bricks[i][j] = true;
-        }
-    }
+    // Serve up and to the right at 45 degrees
+    Fixed8 diagonal = ballSpeed * Fixed8::fromFloat(0.707f);
+    balls.clear();
+    balls.spawn(tft.width() / 2, tft.height() / 2, diagonal, -diagonal);
+    powerUps.clear();
+    bricks.fill();
 }
\ No newline at end of file
@@ -3,40 +3,61 @@
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7735.h>
+#include "ballpool.h"
+#include "brickfield.h"
+#include "fixedpoint.h"
+#include "framebuffer.h"
+#include "game.h"
 #include "inputhandler.h"
+#include "objectpool.h"
 
-class Breakout {
+#define MAX_POWERUPS 4
+#define POWERUP_CHANCE 15 // Percent of broken bricks that drop a multiball
+#define POWERUP_SIZE 4
+#define PADDLE_MAX_SPEED 3    // Pixels per step with the stick fully over
+#define BALL_START_SPEED 1.5f // Pixels per step
+#define BALL_SPEED_STEP 0.25f // Added each time the field is cleared
+#define BALL_MAX_SPEED 3.0f
+
+struct PowerUp {
+  int16_t x, y;
+};
+
+class Breakout : public Game {
 public:
     enum GameState { INTRO, PLAYING, GAME_OVER };
     
-    Breakout(Adafruit_ST7735 &tft, uint8_t buttonPin, uint8_t motorPin, int xPin, int yPin);
-    void init();
-    void update(bool buttonPressed, bool buttonReleased);
-    void render();
-    bool isGameOver();
+    explicit Breakout(FrameBuffer &tft);
+    void init() override;
+    void update(unsigned long dt, InputHandler &input) override;
+    void render(Fixed8 alpha) override;
+    bool wantsMenu() const override;
     
 private:
-    Adafruit_ST7735 &tft;
-    uint8_t buttonPin;
-    uint8_t motorPin;
-    int xPin;
-    int yPin;
+    FrameBuffer &tft;
     GameState state;
+    GameOverInput gameOverInput;
+    bool menuRequested;
     
-    // Game variables
-    int paddleX;
-    int ballX, ballY;
-    int ballSpeedX, ballSpeedY;
-    bool bricks[5][10]; // 5 rows, 10 columns of bricks
+    // Game variables, in sub-pixels so speeds needn't be whole pixels
+    Fixed8 paddleX;
+    Fixed8 prevPaddleX; // Where the paddle was a step ago, for render(alpha)
+    Fixed8 ballSpeed;   // Speed balls leave the paddle at; rises each round
+    BallPool balls;
+    BrickField bricks;
+    ObjectPool<PowerUp, MAX_POWERUPS> powerUps;
     
     // Rendering state variables
     bool introDrawn = false;
     bool gameOverDrawn = false;
-    int lastBallX = 0;
-    int lastBallY = 0;
+    bool fieldDrawn = false; // Bricks are on screen; later only broken ones are redrawn
     int lastPaddleX = 0;
+    PowerUp shownPowerUps[MAX_POWERUPS];
+    uint8_t shownPowerUpCount = 0;
     
-    void renderPixel(int x, int y, uint16_t color);
+    Rect paddleRect() const;
+    void updatePowerUps();
+    void drawPowerUps();
     void renderIntro();
     void renderGameOver();
     void resetGame();
@@ -0,0 +1,147 @@
+#include "brickfield.h"
+
+static const uint16_t rowColors[BRICK_ROWS] = { 0xF800, 0xFD20, 0xFFE0, 0x07E0, 0x001F };
+static const uint16_t FULL_ROW = (1u << BRICK_COLS) - 1;
+
+// Direction leaving each paddle zone, left to right: -60, -45, -30, -15,
+// 15, 30, 45 and 60 degrees from straight up, as (sin, cos)
+static constexpr Fixed8 bounceSin[PADDLE_ZONES] = {
+  Fixed8::fromFloat(-0.866f), Fixed8::fromFloat(-0.707f), Fixed8::fromFloat(-0.5f), Fixed8::fromFloat(-0.259f),
+  Fixed8::fromFloat(0.259f), Fixed8::fromFloat(0.5f), Fixed8::fromFloat(0.707f), Fixed8::fromFloat(0.866f)
+};
+static constexpr Fixed8 bounceCos[PADDLE_ZONES] = {
+  Fixed8::fromFloat(0.5f), Fixed8::fromFloat(0.707f), Fixed8::fromFloat(0.866f), Fixed8::fromFloat(0.966f),
+  Fixed8::fromFloat(0.966f), Fixed8::fromFloat(0.866f), Fixed8::fromFloat(0.707f), Fixed8::fromFloat(0.5f)
+};
+
+// Pixel p with the sub-pixel part of `from`, for an axis that bounced
+static Fixed8 keepFraction(int p, Fixed8 from) {
+  return Fixed8::fromRaw(((int32_t)p << 8) | (from.toRaw() & (Fixed8::ONE - 1)));
+}
+
+BrickField::BrickField() {
+  fill();
+}
+
+void BrickField::fill() {
+  for (int row = 0; row < BRICK_ROWS; row++) {
+    standing[row] = FULL_ROW;
+    destroyed[row] = 0;
+  }
+}
+
+bool BrickField::isCleared() const {
+  for (int row = 0; row < BRICK_ROWS; row++) {
+    if (standing[row]) return false;
+  }
+  return true;
+}
+
+int BrickField::remaining() const {
+  int count = 0;
+  for (int row = 0; row < BRICK_ROWS; row++) {
+    count += __builtin_popcount(standing[row]);
+  }
+  return count;
+}
+
+bool BrickField::hitAt(int x, int y) {
+  x -= BRICK_ORIGIN_X;
+  y -= BRICK_ORIGIN_Y;
+  if (x < 0 || y < 0 || x >= BRICK_COLS * BRICK_WIDTH || y >= BRICK_ROWS * BRICK_HEIGHT) return false;
+
+  int row = y / BRICK_HEIGHT;
+  uint16_t bit = 1u << (x / BRICK_WIDTH);
+  if (!(standing[row] & bit)) return false;
+  standing[row] &= ~bit;
+  destroyed[row] |= bit;
+  return true;
+}
+
+uint8_t BrickField::sweep(Ball &ball, const Rect &paddle, Fixed8 speed) {
+  uint8_t result = 0;
+  int px = ball.x.toInt(), py = ball.y.toInt();
+  Fixed8 nextX = ball.x + ball.vx, nextY = ball.y + ball.vy;
+  int moveX = nextX.toInt() - px, moveY = nextY.toInt() - py;
+  int totalX = abs(moveX), totalY = abs(moveY);
+  int leftX = totalX, leftY = totalY;
+  bool bouncedX = false, bouncedY = false;
+
+  // Cross the pixel boundaries of this step in order, stepping the axis
+  // that is furthest behind its share of the move; a bounce ends that
+  // axis' movement for the step
+  while (leftX || leftY) {
+    if (leftX && leftX * totalY >= leftY * totalX) {
+      leftX--;
+      int sx = moveX > 0 ? 1 : -1;
+      int x = px + sx;
+      int lead = sx > 0 ? x + BALL_SIZE - 1 : x;
+      // Test both bricks the leading edge touches; either one bounces
+      bool hit = hitAt(lead, py);
+      hit |= hitAt(lead, py + BALL_SIZE - 1);
+      if (hit) result |= HIT_BRICK;
+      if (hit || x < 0 || x + BALL_SIZE > FRAMEBUFFER_WIDTH) {
+        ball.vx = -ball.vx;
+        bouncedX = true;
+        leftX = 0;
+      } else {
+        px = x;
+      }
+    } else {
+      leftY--;
+      int sy = moveY > 0 ? 1 : -1;
+      int y = py + sy;
+      int lead = sy > 0 ? y + BALL_SIZE - 1 : y;
+      bool hit = hitAt(px, lead);
+      hit |= hitAt(px + BALL_SIZE - 1, lead);
+      if (hit) result |= HIT_BRICK;
+
+      bool onPaddle = sy > 0 && lead == paddle.y &&
+                      px + BALL_SIZE > paddle.x && px < paddle.x + paddle.w;
+      if (onPaddle) {
+        result |= HIT_PADDLE;
+        int zone = (px + BALL_SIZE / 2 - paddle.x) * PADDLE_ZONES / paddle.w;
+        zone = constrain(zone, 0, PADDLE_ZONES - 1);
+        ball.vx = speed * bounceSin[zone];
+        ball.vy = -(speed * bounceCos[zone]);
+      } else if (hit || y < 0) {
+        ball.vy = -ball.vy;
+      }
+      if (hit || onPaddle || y < 0) {
+        bouncedY = true;
+        leftY = 0;
+      } else {
+        py = y;
+      }
+    }
+  }
+
+  ball.x = bouncedX ? keepFraction(px, ball.x) : nextX;
+  ball.y = bouncedY ? keepFraction(py, ball.y) : nextY;
+  return result;
+}
+
+void BrickField::drawBrick(Adafruit_GFX &gfx, int row, int col, uint16_t color) {
+  gfx.fillRect(BRICK_ORIGIN_X + col * BRICK_WIDTH, BRICK_ORIGIN_Y + row * BRICK_HEIGHT,
+               BRICK_WIDTH - 1, BRICK_HEIGHT - 1, color);
+}
+
+void BrickField::draw(Adafruit_GFX &gfx) {
+  for (int row = 0; row < BRICK_ROWS; row++) {
+    for (int col = 0; col < BRICK_COLS; col++) {
+      drawBrick(gfx, row, col, (standing[row] >> col) & 1 ? rowColors[row] : 0);
+    }
+    destroyed[row] = 0;
+  }
+}
+
+void BrickField::drawChanges(Adafruit_GFX &gfx) {
+  for (int row = 0; row < BRICK_ROWS; row++) {
+    uint16_t bits = destroyed[row];
+    while (bits) {
+      drawBrick(gfx, row, __builtin_ctz(bits), 0);
+      bits &= bits - 1;
+    }
+    destroyed[row] = 0;
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef BRICKFIELD_H
+#define BRICKFIELD_H
+
+#include <Adafruit_GFX.h>
+#include "displaybackend.h"
+#include "fixedpoint.h"
+
+#define BRICK_ROWS 5
+#define BRICK_COLS 10
+#define BRICK_WIDTH 12 // Cell size; the brick drawn inside leaves a 1px gap
+#define BRICK_HEIGHT 5
+#define BRICK_ORIGIN_X ((FRAMEBUFFER_WIDTH - BRICK_COLS * BRICK_WIDTH) / 2)
+#define BRICK_ORIGIN_Y 16
+#define BALL_SIZE 2
+#define PADDLE_ZONES 8 // Bounce angles across the paddle, steepest at the ends
+
+struct Ball {
+  Fixed8 x, y;   // Top left, in pixels
+  Fixed8 vx, vy; // Pixels per step
+};
+
+struct Rect {
+  int16_t x, y, w, h;
+};
+
+// Bricks as one bitmask per row, bit c set while the brick in column c is
+// standing. A pixel maps straight to its cell, so a collision test is a
+// division and a bit test however many bricks are left. Destroyed bricks
+// are remembered in a second mask until drawChanges() erases them.
+class BrickField {
+public:
+  enum SweepResult : uint8_t {
+    HIT_BRICK = 0x01,
+    HIT_PADDLE = 0x02,
+  };
+
+  BrickField();
+
+  // Stand every brick up again; draw() then shows them all
+  void fill();
+  bool isCleared() const;
+  int remaining() const;
+
+  // Move the ball by its velocity, crossing one pixel at a time and
+  // bouncing off the side and top walls, bricks and the paddle, so no
+  // speed can tunnel through anything. The paddle sends the ball off at
+  // `speed` with an angle set by where it was hit. Returns the
+  // SweepResult bits for what it hit.
+  uint8_t sweep(Ball &ball, const Rect &paddle, Fixed8 speed);
+
+  void draw(Adafruit_GFX &gfx);
+  // Erase the bricks destroyed since the last draw
+  void drawChanges(Adafruit_GFX &gfx);
+
+private:
+  bool hitAt(int x, int y);
+  void drawBrick(Adafruit_GFX &gfx, int row, int col, uint16_t color);
+
+  uint16_t standing[BRICK_ROWS];
+  uint16_t destroyed[BRICK_ROWS]; // Not yet erased from the screen
+};
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <Arduino.h>
+
+// Pin definitions for TFT display
+#define TFT_CS D0 // Chip Select
+#define TFT_RST D1 // Reset
+#define TFT_DC D2 // Data/Command
+#define TFT_MOSI D3
+#define TFT_SCLK D4
+#define TFT_LED D5
+
+// Joystick pins
+#define X_PIN 5 // Analog pin A0
+#define Y_PIN 4 // Analog pin A1
+#define Button_PIN D10
+#define Vibrationmotor_PIN D9
+
+#endif
@@ -0,0 +1,188 @@
+#include "dirtyregion.h"
+
+// Extra pixels we accept pushing to save an address window setup
+#define MERGE_SLACK 32
+
+DirtyRegion::DirtyRegion() : _count(0), _spanTop(0), _spanBottom(0) {
+  memset(_spans, 0, sizeof(_spans));
+}
+
+void DirtyRegion::clear() {
+  _count = 0;
+  if (_spanBottom > _spanTop) {
+    memset(_spans[_spanTop], 0, (_spanBottom - _spanTop) * sizeof(_spans[0]));
+  }
+  _spanTop = _spanBottom = 0;
+}
+
+uint32_t DirtyRegion::area() const {
+  uint32_t total = 0;
+  for (int i = 0; i < _count; i++) {
+    total += areaOf(_rects[i]);
+  }
+  for (int y = _spanTop; y < _spanBottom; y++) {
+    for (int w = 0; w < DIRTY_SPAN_WORDS; w++) {
+      total += __builtin_popcount(_spans[y][w]);
+    }
+  }
+  return total;
+}
+
+int DirtyRegion::windowCount() const {
+  int windows = _count;
+  DirtyRect span = {0, 0, 0, 1};
+  while (nextSpan(span)) windows++;
+  return windows;
+}
+
+void DirtyRegion::add(int16_t x, int16_t y, int16_t w, int16_t h) {
+  if (w <= 0 || h <= 0) return;
+
+  DirtyRect r = {x, y, w, h};
+  insert(r);
+}
+
+// Already inside a rectangle that goes out anyway
+bool DirtyRegion::covered(int16_t x, int16_t y, int16_t w) const {
+  for (int i = 0; i < _count; i++) {
+    const DirtyRect &r = _rects[i];
+    if (x >= r.x && x + w <= r.x + r.w && y >= r.y && y < r.y + r.h) return true;
+  }
+  return false;
+}
+
+void DirtyRegion::addSpan(int16_t x, int16_t y, int16_t w) {
+  if (x < 0) { w += x; x = 0; }
+  if (x + w > FRAMEBUFFER_WIDTH) w = FRAMEBUFFER_WIDTH - x;
+  if (w <= 0 || y < 0 || y >= FRAMEBUFFER_HEIGHT || covered(x, y, w)) return;
+
+  if (_spanBottom <= _spanTop) {
+    _spanTop = y;
+    _spanBottom = y + 1;
+  } else if (y < _spanTop) {
+    _spanTop = y;
+  } else if (y >= _spanBottom) {
+    _spanBottom = y + 1;
+  }
+
+  while (w > 0) {
+    int word = x >> 5, shift = x & 31;
+    int bits = w < 32 - shift ? w : 32 - shift;
+    uint32_t mask = bits == 32 ? ~0u : ((1u << bits) - 1) << shift;
+    _spans[y][word] |= mask;
+    x += bits;
+    w -= bits;
+  }
+}
+
+bool DirtyRegion::spanBit(int y, int x) const {
+  return x >= 0 && x < FRAMEBUFFER_WIDTH && (_spans[y][x >> 5] >> (x & 31)) & 1;
+}
+
+int DirtyRegion::runEnd(int y, int x) const {
+  while (x < FRAMEBUFFER_WIDTH) {
+    uint32_t clear = ~_spans[y][x >> 5] >> (x & 31);
+    if (clear) return x + __builtin_ctz(clear);
+    x = (x | 31) + 1;
+  }
+  return FRAMEBUFFER_WIDTH;
+}
+
+bool DirtyRegion::sameRun(int y, int x, int end) const {
+  return spanBit(y, x) && !spanBit(y, x - 1) && runEnd(y, x) == end;
+}
+
+bool DirtyRegion::nextSpan(DirtyRect &span) const {
+  int y = span.y < _spanTop ? _spanTop : span.y;
+  int x = span.y < _spanTop ? 0 : span.x + span.w;
+  for (; y < _spanBottom; y++, x = 0) {
+    while (x < FRAMEBUFFER_WIDTH) {
+      // Bits from x on in its word
+      uint32_t bits = _spans[y][x >> 5] >> (x & 31);
+      if (!bits) {
+        x = (x | 31) + 1;
+        continue;
+      }
+      x += __builtin_ctz(bits);
+
+      // The run may carry on into the next words
+      int end = runEnd(y, x);
+
+      // A run that repeats the one above went out with it
+      if (y > _spanTop && sameRun(y - 1, x, end)) {
+        x = end;
+        continue;
+      }
+
+      // Rows below with exactly this run share its window
+      int bottom = y + 1;
+      while (bottom < _spanBottom && sameRun(bottom, x, end)) bottom++;
+
+      span.x = x;
+      span.y = y;
+      span.w = end - x;
+      span.h = bottom - y;
+      return true;
+    }
+  }
+  return false;
+}
+
+DirtyRect DirtyRegion::unite(const DirtyRect &a, const DirtyRect &b) {
+  int16_t x0 = a.x < b.x ? a.x : b.x;
+  int16_t y0 = a.y < b.y ? a.y : b.y;
+  int16_t x1 = (a.x + a.w) > (b.x + b.w) ? (a.x + a.w) : (b.x + b.w);
+  int16_t y1 = (a.y + a.h) > (b.y + b.h) ? (a.y + a.h) : (b.y + b.h);
+  DirtyRect r = {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+  return r;
+}
+
+bool DirtyRegion::shouldMerge(const DirtyRect &a, const DirtyRect &b) {
+  // Merge when the bounding box costs little more than the two parts
+  return areaOf(unite(a, b)) <= areaOf(a) + areaOf(b) + MERGE_SLACK;
+}
+
+void DirtyRegion::insert(DirtyRect r) {
+  // Absorb every rectangle the new one should be merged with. Each merge
+  // grows r, so restart the scan until nothing else qualifies.
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (int i = 0; i < _count; i++) {
+      if (shouldMerge(_rects[i], r)) {
+        r = unite(_rects[i], r);
+        _rects[i] = _rects[--_count];
+        merged = true;
+        break;
+      }
+    }
+  }
+
+  _rects[_count++] = r;
+  if (_count > MAX_DIRTY_RECTS) {
+    mergeCheapestPair();
+  }
+}
+
+void DirtyRegion::mergeCheapestPair() {
+  // Out of slots: fold the pair whose union wastes the fewest pixels
+  int bestA = 0;
+  int bestB = 1;
+  int32_t bestCost = INT32_MAX;
+
+  for (int a = 0; a < _count; a++) {
+    for (int b = a + 1; b < _count; b++) {
+      int32_t cost = areaOf(unite(_rects[a], _rects[b])) - areaOf(_rects[a]) - areaOf(_rects[b]);
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestA = a;
+        bestB = b;
+      }
+    }
+  }
+
+  DirtyRect r = unite(_rects[bestA], _rects[bestB]);
+  _rects[bestB] = _rects[--_count];
+  _rects[bestA] = _rects[--_count];
+  insert(r);
+}
@@ -0,0 +1,71 @@
+#ifndef DIRTYREGION_H
+#define DIRTYREGION_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define FRAMEBUFFER_WIDTH 128
+#define FRAMEBUFFER_HEIGHT 128
+
+#define MAX_DIRTY_RECTS 8 // Rectangles kept before neighbours are merged
+#define DIRTY_SPAN_WORDS (FRAMEBUFFER_WIDTH / 32)
+
+struct DirtyRect {
+  int16_t x, y, w, h;
+};
+
+// Tracks the screen areas touched since the last flush.
+// Overlapping or nearby rectangles are coalesced so a frame ends up as a
+// handful of address windows instead of one per draw call.
+// Spans are one-row runs kept apart from the rectangles in a bit per
+// pixel map: they are never merged into each other or into a rectangle,
+// only runs that touch on a row, or the same run on consecutive rows, go
+// out as one window. They are for callers that know exactly which pixels
+// changed, scattered over the screen, where any bounding box would push
+// mostly unchanged pixels.
+class DirtyRegion {
+public:
+  DirtyRegion();
+
+  void add(int16_t x, int16_t y, int16_t w, int16_t h);
+  void addSpan(int16_t x, int16_t y, int16_t w);
+  void clear();
+
+  bool empty() const { return _count == 0 && _spanBottom <= _spanTop; }
+
+  int count() const { return _count; }
+  const DirtyRect &rect(int index) const { return _rects[index]; }
+
+  // Step through the spans in row order: start from a rect zeroed with
+  // h = 1, each call moves it to the next run; false after the last one.
+  // A run repeated exactly on the rows below comes back once, with h
+  // covering them all.
+  bool nextSpan(DirtyRect &span) const;
+
+  // Pixels in the rectangles plus pixels in the spans
+  uint32_t area() const;
+
+  // Address windows a flush of the region opens
+  int windowCount() const;
+
+private:
+  static DirtyRect unite(const DirtyRect &a, const DirtyRect &b);
+  static int32_t areaOf(const DirtyRect &r) { return (int32_t)r.w * r.h; }
+  static bool shouldMerge(const DirtyRect &a, const DirtyRect &b);
+
+  void insert(DirtyRect r);
+  void mergeCheapestPair();
+
+  bool covered(int16_t x, int16_t y, int16_t w) const;
+  bool spanBit(int y, int x) const;
+  int runEnd(int y, int x) const; // First clear bit at or after x
+  bool sameRun(int y, int x, int end) const; // Row y has a run of exactly [x, end)
+
+  DirtyRect _rects[MAX_DIRTY_RECTS + 1]; // One spare slot before merging
+  int _count;
+
+  uint32_t _spans[FRAMEBUFFER_HEIGHT][DIRTY_SPAN_WORDS]; // Bit x of row y, 32 to a word
+  int16_t _spanTop, _spanBottom; // Rows that may hold span bits, bottom exclusive
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "displaybackend.h"
+
+void GfxBackend::push(const uint16_t *pixels, const DirtyRegion &region, FlushStats &stats) {
+  if (region.empty()) return;
+
+  unsigned long start = micros();
+  // writePixels() doesn't modify the buffer, it just isn't declared const
+  uint16_t *src = const_cast<uint16_t *>(pixels);
+
+  display.startWrite();
+  for (int i = 0; i < region.count(); i++) {
+    const DirtyRect &r = region.rect(i);
+    display.setAddrWindow(r.x, r.y, r.w, r.h);
+    stats.windowsOpened++;
+
+    if (r.w == FRAMEBUFFER_WIDTH) {
+      // Full-width rows are contiguous, send them in one burst
+      display.writePixels(&src[r.y * FRAMEBUFFER_WIDTH], (uint32_t)r.w * r.h);
+    } else {
+      for (int16_t row = r.y; row < r.y + r.h; row++) {
+        display.writePixels(&src[row * FRAMEBUFFER_WIDTH + r.x], r.w);
+      }
+    }
+    stats.pixelsPushed += (uint32_t)r.w * r.h;
+  }
+
+  DirtyRect span = {0, 0, 0, 1};
+  while (region.nextSpan(span)) {
+    display.setAddrWindow(span.x, span.y, span.w, span.h);
+    stats.windowsOpened++;
+    for (int16_t row = span.y; row < span.y + span.h; row++) {
+      display.writePixels(&src[row * FRAMEBUFFER_WIDTH + span.x], span.w);
+    }
+    stats.pixelsPushed += (uint32_t)span.w * span.h;
+  }
+  display.endWrite();
+
+  // Every pixel went out before returning
+  stats.stallUs += micros() - start;
+}
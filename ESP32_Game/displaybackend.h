@@ -0,0 +1,48 @@
+#ifndef DISPLAYBACKEND_H
+#define DISPLAYBACKEND_H
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_ST7735.h>
+#include "dirtyregion.h"
+
+// Bytes sent to open an address window: CASET and RASET with four
+// parameter bytes each, then RAMWR
+#define ADDR_WINDOW_BYTES 11
+
+// Cost of the flushes since the last resetStats()
+struct FlushStats {
+  uint32_t drawCalls;     // Primitives drawn into the canvas
+  uint32_t windowsOpened; // Address windows set on the display (ADDR_WINDOW_BYTES each)
+  uint32_t pixelsPushed;  // Pixels sent over SPI (2 bytes each)
+  uint32_t stallUs;       // Time the caller spent blocked on the bus
+};
+
+// Where flushed pixels go.
+// push() gets a FRAMEBUFFER_WIDTH-wide RGB565 buffer and the rectangles
+// and spans of it to send. It may return while pixels are still on the wire, but must
+// not read the buffer after returning, so drawing can carry on at once.
+class DisplayBackend {
+public:
+  virtual ~DisplayBackend() {}
+
+  // Take over the bus; false if the hardware could not be set up
+  virtual bool begin() { return true; }
+
+  virtual void push(const uint16_t *pixels, const DirtyRegion &region, FlushStats &stats) = 0;
+
+  // Block until everything push() queued has been sent
+  virtual void wait() {}
+};
+
+// Blocking writes through the Adafruit driver
+class GfxBackend : public DisplayBackend {
+public:
+  GfxBackend(Adafruit_SPITFT &display) : display(display) {}
+
+  void push(const uint16_t *pixels, const DirtyRegion &region, FlushStats &stats) override;
+
+private:
+  Adafruit_SPITFT &display;
+};
+
+#endif
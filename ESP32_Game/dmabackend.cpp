@@ -0,0 +1,211 @@
+#include "dmabackend.h"
+
+#if DISPLAY_DMA
+
+#include <driver/gpio.h>
+#include <esp_heap_caps.h>
+#include "logger.h"
+
+#define ST77XX_CASET 0x2A
+#define ST77XX_RASET 0x2B
+#define ST77XX_RAMWR 0x2C
+
+// Transaction user field: level for the DC pin
+#define DC_COMMAND ((void *)0)
+#define DC_DATA ((void *)1)
+
+int DmaBackend::dcPin = -1;
+
+DmaBackend::DmaBackend(Adafruit_ST7735 &panel, int mosiPin, int sclkPin, int csPin, int dcPin) :
+  panel(panel), mosiPin(mosiPin), sclkPin(sclkPin), csPin(csPin), busInitialized(false),
+  device(nullptr), nextBuffer(0), inFlight(0) {
+  DmaBackend::dcPin = dcPin;
+  for (int i = 0; i < DMA_LINE_POOL_SIZE; i++) {
+    linePool[i] = nullptr;
+  }
+}
+
+void IRAM_ATTR DmaBackend::onPreTransfer(spi_transaction_t *transaction) {
+  gpio_set_level((gpio_num_t)dcPin, (int)(intptr_t)transaction->user);
+}
+
+// Undo whatever part of begin() succeeded
+void DmaBackend::release() {
+  if (device) {
+    spi_bus_remove_device(device);
+    device = nullptr;
+  }
+  if (busInitialized) {
+    spi_bus_free(DMA_SPI_HOST);
+    busInitialized = false;
+  }
+  for (int i = 0; i < DMA_LINE_POOL_SIZE; i++) {
+    heap_caps_free(linePool[i]);
+    linePool[i] = nullptr;
+  }
+}
+
+bool DmaBackend::begin() {
+  // The window offsets below are the rotation 0 ones
+  if (panel.getRotation() != 0) {
+    LOG_ERROR(LOG_MODULE_MAIN, "DMA flush only supports display rotation 0");
+    return false;
+  }
+
+  for (int i = 0; i < DMA_LINE_POOL_SIZE; i++) {
+    linePool[i] = (uint16_t *)heap_caps_malloc(DMA_LINE_POOL_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA);
+    if (!linePool[i]) {
+      LOG_ERROR(LOG_MODULE_MAIN, "DMA line buffer allocation failed");
+      release();
+      return false;
+    }
+  }
+
+  spi_bus_config_t bus = {};
+  bus.mosi_io_num = mosiPin;
+  bus.miso_io_num = -1;
+  bus.sclk_io_num = sclkPin;
+  bus.quadwp_io_num = -1;
+  bus.quadhd_io_num = -1;
+  bus.max_transfer_sz = DMA_LINE_POOL_PIXELS * sizeof(uint16_t);
+  if (spi_bus_initialize(DMA_SPI_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK) {
+    LOG_ERROR(LOG_MODULE_MAIN, "SPI bus init failed");
+    release();
+    return false;
+  }
+  busInitialized = true;
+
+  spi_device_interface_config_t config = {};
+  config.clock_speed_hz = DMA_SPI_FREQUENCY;
+  config.mode = 0;
+  config.spics_io_num = csPin;
+  config.queue_size = DMA_LINE_POOL_SIZE;
+  config.pre_cb = onPreTransfer;
+  if (spi_bus_add_device(DMA_SPI_HOST, &config, &device) != ESP_OK) {
+    LOG_ERROR(LOG_MODULE_MAIN, "SPI device init failed");
+    device = nullptr;
+    release();
+    return false;
+  }
+
+  pinMode(dcPin, OUTPUT);
+  return true;
+}
+
+void DmaBackend::sendCommand(uint8_t command, const uint8_t *data, uint8_t length) {
+  // Small and rare, so these are polled rather than queued
+  spi_transaction_t t;
+  memset(&t, 0, sizeof(t));
+  t.flags = SPI_TRANS_USE_TXDATA;
+  t.length = 8;
+  t.tx_data[0] = command;
+  t.user = DC_COMMAND;
+  spi_device_polling_transmit(device, &t);
+
+  if (length == 0) return;
+  memset(&t, 0, sizeof(t));
+  t.flags = SPI_TRANS_USE_TXDATA;
+  t.length = length * 8;
+  memcpy(t.tx_data, data, length);
+  t.user = DC_DATA;
+  spi_device_polling_transmit(device, &t);
+}
+
+void DmaBackend::setWindow(const DirtyRect &r) {
+  uint16_t x0 = r.x + ST7735_COLSTART, x1 = x0 + r.w - 1;
+  uint16_t y0 = r.y + ST7735_ROWSTART, y1 = y0 + r.h - 1;
+  uint8_t columns[4] = { (uint8_t)(x0 >> 8), (uint8_t)x0, (uint8_t)(x1 >> 8), (uint8_t)x1 };
+  uint8_t rows[4] = { (uint8_t)(y0 >> 8), (uint8_t)y0, (uint8_t)(y1 >> 8), (uint8_t)y1 };
+
+  sendCommand(ST77XX_CASET, columns, 4);
+  sendCommand(ST77XX_RASET, rows, 4);
+  sendCommand(ST77XX_RAMWR, nullptr, 0);
+}
+
+void DmaBackend::waitForOldest() {
+  spi_transaction_t *done;
+  spi_device_get_trans_result(device, &done, portMAX_DELAY);
+  inFlight--;
+}
+
+void DmaBackend::wait() {
+  while (inFlight > 0) {
+    waitForOldest();
+  }
+}
+
+uint16_t *DmaBackend::nextLineBuffer(FlushStats &stats) {
+  // Buffers are reused in order, so the oldest transaction holds this one
+  if (inFlight == DMA_LINE_POOL_SIZE) {
+    unsigned long start = micros();
+    waitForOldest();
+    stats.stallUs += micros() - start;
+  }
+  return linePool[nextBuffer];
+}
+
+void DmaBackend::queueLineBuffer(int pixelCount) {
+  spi_transaction_t &t = lineTransactions[nextBuffer];
+  memset(&t, 0, sizeof(t));
+  t.length = pixelCount * 16;
+  t.tx_buffer = linePool[nextBuffer];
+  t.user = DC_DATA;
+  spi_device_queue_trans(device, &t, portMAX_DELAY);
+
+  inFlight++;
+  nextBuffer = (nextBuffer + 1) % DMA_LINE_POOL_SIZE;
+}
+
+void DmaBackend::pushRect(const uint16_t *pixels, const DirtyRect &r, FlushStats &stats) {
+  // Window commands are polled, which needs the queue to be empty
+  unsigned long start = micros();
+  wait();
+  stats.stallUs += micros() - start;
+
+  setWindow(r);
+  stats.windowsOpened++;
+
+  // Rows of the window are one continuous stream, so a buffer can end
+  // and the next begin anywhere inside a row
+  uint16_t *line = nullptr;
+  int fill = 0;
+  for (int16_t row = r.y; row < r.y + r.h; row++) {
+    const uint16_t *src = &pixels[row * FRAMEBUFFER_WIDTH + r.x];
+    int remaining = r.w;
+    while (remaining > 0) {
+      if (!line) {
+        line = nextLineBuffer(stats);
+        fill = 0;
+      }
+      int count = min(remaining, DMA_LINE_POOL_PIXELS - fill);
+      for (int p = 0; p < count; p++) {
+        // The panel wants big-endian RGB565
+        line[fill + p] = (uint16_t)((src[p] >> 8) | (src[p] << 8));
+      }
+      fill += count;
+      src += count;
+      remaining -= count;
+
+      if (fill == DMA_LINE_POOL_PIXELS) {
+        queueLineBuffer(fill);
+        line = nullptr;
+      }
+    }
+  }
+  if (line && fill > 0) {
+    queueLineBuffer(fill);
+  }
+  stats.pixelsPushed += (uint32_t)r.w * r.h;
+}
+
+void DmaBackend::push(const uint16_t *pixels, const DirtyRegion &region, FlushStats &stats) {
+  for (int i = 0; i < region.count(); i++) {
+    pushRect(pixels, region.rect(i), stats);
+  }
+  DirtyRect span = {0, 0, 0, 1};
+  while (region.nextSpan(span)) {
+    pushRect(pixels, span, stats);
+  }
+}
+
+#endif
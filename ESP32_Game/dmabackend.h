@@ -0,0 +1,67 @@
+#ifndef DMABACKEND_H
+#define DMABACKEND_H
+
+#include <Arduino.h>
+#include "displaybackend.h"
+
+#ifndef DISPLAY_DMA
+#define DISPLAY_DMA 0 // Set to 1 to flush through the SPI peripheral with DMA
+#endif
+
+#if DISPLAY_DMA
+
+#include <driver/spi_master.h>
+
+#define DMA_SPI_HOST SPI2_HOST
+#define DMA_SPI_FREQUENCY 40000000
+#define DMA_LINE_POOL_SIZE 2 // Buffers in flight; one fills while the other sends
+#define DMA_LINE_POOL_PIXELS (FRAMEBUFFER_WIDTH * 16)
+
+// ST7735 1.44" green tab: the 128x128 panel sits at this offset in RAM.
+// Only true at rotation 0; the others move the panel to another corner, so
+// begin() refuses them.
+#define ST7735_COLSTART 2
+#define ST7735_ROWSTART 3
+
+// Flushes through the ESP-IDF SPI master driver instead of bit-banging.
+// Pixels are byte-swapped into a small pool of DMA-capable line buffers and
+// queued as transactions, so the CPU fills one buffer while the previous
+// one is on the wire. push() returns with the last buffers still sending;
+// they only cost time if the next push() catches up with them. The
+// Adafruit driver still sends the panel init sequence; begin() then moves
+// the pins over to the SPI peripheral. On failure begin() releases
+// everything it took, so the sketch can fall back to GfxBackend.
+class DmaBackend : public DisplayBackend {
+public:
+  DmaBackend(Adafruit_ST7735 &panel, int mosiPin, int sclkPin, int csPin, int dcPin);
+
+  bool begin() override;
+  void push(const uint16_t *pixels, const DirtyRegion &region, FlushStats &stats) override;
+  void wait() override;
+
+private:
+  static void IRAM_ATTR onPreTransfer(spi_transaction_t *transaction);
+  static int dcPin; // Read by onPreTransfer
+
+  void sendCommand(uint8_t command, const uint8_t *data, uint8_t length);
+  void setWindow(const DirtyRect &r);
+  void pushRect(const uint16_t *pixels, const DirtyRect &r, FlushStats &stats);
+  uint16_t *nextLineBuffer(FlushStats &stats);
+  void queueLineBuffer(int pixelCount);
+  void waitForOldest();
+  void release();
+
+  Adafruit_ST7735 &panel;
+  int mosiPin, sclkPin, csPin;
+  bool busInitialized;
+  spi_device_handle_t device;
+
+  uint16_t *linePool[DMA_LINE_POOL_SIZE];
+  spi_transaction_t lineTransactions[DMA_LINE_POOL_SIZE];
+  int nextBuffer;
+  int inFlight;
+};
+
+#endif
+
+#endif
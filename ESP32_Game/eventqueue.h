@@ -0,0 +1,55 @@
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Lock-free single-producer/single-consumer ring buffer.
+// The producer (an ISR) only writes _head and the consumer only writes
+// _tail, so no critical section is needed. Capacity must be a power of two
+// and one slot is kept free to tell a full queue from an empty one.
+template <typename T, uint8_t Capacity>
+class EventQueue {
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+  EventQueue() : _head(0), _tail(0), _dropped(0) {}
+
+  // Producer side. Returns false (and counts the loss) when full.
+  bool push(const T &item) {
+    uint8_t head = _head.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) & (Capacity - 1);
+    if (next == _tail.load(std::memory_order_acquire)) {
+      // Only the producer writes it, so no read-modify-write is needed
+      _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    _items[head] = item;
+    _head.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side
+  bool pop(T &item) {
+    uint8_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+
+    item = _items[tail];
+    _tail.store((tail + 1) & (Capacity - 1), std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+  }
+
+  uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+  T _items[Capacity];
+  std::atomic<uint8_t> _head;
+  std::atomic<uint8_t> _tail;
+  std::atomic<uint32_t> _dropped;
+};
+
+#endif
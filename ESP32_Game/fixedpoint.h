@@ -0,0 +1,62 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <stdint.h>
+
+// Signed Q-format number: a 32-bit integer holding value * 2^FracBits.
+// Game physics use it instead of float so the same inputs always give the
+// same positions, bit for bit, whatever compiler or FPU runs them, and so
+// drawing only needs a shift to get pixel coordinates. Constants are
+// converted from float at compile time with fromFloat().
+template <int FracBits>
+class Fixed {
+  static_assert(FracBits > 0 && FracBits < 31, "FracBits must leave room for an integer part");
+
+public:
+  static constexpr int32_t ONE = (int32_t)1 << FracBits;
+
+  constexpr Fixed() : raw(0) {}
+  constexpr Fixed(int value) : raw(value * ONE) {}
+
+  static constexpr Fixed fromRaw(int32_t raw) { return Fixed(raw, RawTag()); }
+  static constexpr Fixed fromFloat(float value) {
+    return fromRaw((int32_t)(value * ONE + (value < 0 ? -0.5f : 0.5f)));
+  }
+
+  // Whole part, rounded towards negative infinity
+  constexpr int toInt() const { return raw >> FracBits; }
+  constexpr int round() const { return (raw + ONE / 2) >> FracBits; }
+  constexpr float toFloat() const { return (float)raw / ONE; }
+  constexpr int32_t toRaw() const { return raw; }
+
+  constexpr Fixed operator-() const { return fromRaw(-raw); }
+  Fixed &operator+=(Fixed other) { raw += other.raw; return *this; }
+  Fixed &operator-=(Fixed other) { raw -= other.raw; return *this; }
+
+  friend constexpr Fixed operator+(Fixed a, Fixed b) { return fromRaw(a.raw + b.raw); }
+  friend constexpr Fixed operator-(Fixed a, Fixed b) { return fromRaw(a.raw - b.raw); }
+  friend constexpr Fixed operator*(Fixed a, Fixed b) {
+    return fromRaw((int32_t)(((int64_t)a.raw * b.raw) >> FracBits));
+  }
+  friend constexpr Fixed operator/(Fixed a, Fixed b) {
+    return fromRaw((int32_t)(((int64_t)a.raw << FracBits) / b.raw));
+  }
+
+  friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+  friend constexpr bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+  friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+  friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+  friend constexpr bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+  friend constexpr bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+private:
+  struct RawTag {};
+  constexpr Fixed(int32_t raw, RawTag) : raw(raw) {}
+
+  int32_t raw;
+};
+
+// 24.8: whole screen coordinates with 1/256 pixel steps
+typedef Fixed<8> Fixed8;
+
+#endif
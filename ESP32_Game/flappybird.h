@@ -3,6 +3,14 @@
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7735.h>
+#include "config.h"
+#include "fixedpoint.h"
+#include "framebuffer.h"
+#include "game.h"
+#include "inputhandler.h"
+#include "linecompositor.h"
+#include "sprite.h"
+#include "vibration.h"
 #include <SPI.h>
 
 // Game constants
@@ -15,6 +23,10 @@
 #define MAX_PIPES 3
 #define FRAME_TIME 16  // Target ~60 FPS (1000ms/60)
 #define BUFFER_HEIGHT 20  // Height of update buffer regions
+#define SCORE_BOX_X 5
+#define SCORE_BOX_Y 5
+#define SCORE_BOX_WIDTH 50
+#define SCORE_BOX_HEIGHT 10
 
 // Colors
 #define BLACK 0x0000
@@ -23,12 +35,25 @@
 #define BLUE 0x001F
 #define YELLOW 0xFFE0
 #define RED 0xF800
+#define HILL_LIGHT 0x3D8C
+#define HILL_DARK 0x2C8A
+#define GRASS 0x4E60
+#define GRASS_DARK 0x3580
+#define DIRT 0xAB86
+#define DIRT_DARK 0x8AA4
+#define PIPE_COLOR_DARK 0x0320 // Pipe shades, dark rim to light cap
+#define PIPE_COLOR_BODY 0x07E0
+#define PIPE_COLOR_LIGHT 0x87F0
+
+// Bird physics run in 24.8 fixed point so a run replays identically
+static constexpr Fixed8 BIRD_GRAVITY = Fixed8::fromFloat(GRAVITY);
+static constexpr Fixed8 BIRD_JUMP_FORCE = Fixed8::fromFloat(JUMP_FORCE);
 
 // Game objects
 struct Bird {
-  float x, y;
-  float prevX, prevY;
-  float velocity;
+  int x, prevX;
+  Fixed8 y, prevY;
+  Fixed8 velocity;
   bool needsUpdate;
 };
 
@@ -36,13 +61,67 @@ struct Pipe {
   int x, prevX;
   int gapY;
   bool passed;
-  bool needsUpdate;
-  int prevTopHeight;
-  int prevBottomY;
 };
 
+// Parallax background: distant hills at 1/8 of the pipe speed and the
+// ground moving with the pipes
+#define HILLS_TOP 88
+#define HILLS_HEIGHT 28
+#define GROUND_TOP (HILLS_TOP + HILLS_HEIGHT)
+#define GROUND_HEIGHT (FRAMEBUFFER_HEIGHT - GROUND_TOP)
+
+static constexpr uint8_t hillSkyline[64] = {
+  19, 18, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 9, 8, 8, 8,
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 7, 7, 6, 6,
+  5, 4, 4, 3, 3, 2, 2, 2, 2, 2, 2, 3, 3, 4, 5, 7,
+  8, 9, 11, 12, 14, 15, 16, 17, 18, 19, 20, 20, 20, 20, 20, 20
+};
+static constexpr uint16_t hillColors[HILLS_HEIGHT] = {
+  HILL_LIGHT, HILL_LIGHT, HILL_LIGHT, HILL_LIGHT, HILL_LIGHT, HILL_LIGHT, HILL_LIGHT,
+  HILL_LIGHT, HILL_LIGHT, HILL_LIGHT, HILL_LIGHT, HILL_LIGHT, HILL_DARK, HILL_DARK,
+  HILL_DARK, HILL_DARK, HILL_DARK, HILL_DARK, HILL_DARK, HILL_DARK, HILL_DARK,
+  HILL_DARK, HILL_DARK, HILL_DARK, HILL_DARK, HILL_DARK, HILL_DARK, HILL_DARK
+};
+static constexpr uint8_t groundSkyline[8] = { 0, 0, 1, 2, 2, 1, 0, 0 };
+static constexpr uint16_t groundColors[GROUND_HEIGHT] = {
+  GRASS, GRASS, GRASS, GRASS_DARK, DIRT, DIRT, DIRT_DARK, DIRT, DIRT, DIRT_DARK, DIRT, DIRT
+};
+static constexpr ParallaxLayer flappyLayers[] = {
+  { HILLS_TOP, HILLS_HEIGHT, 3, 64, hillSkyline, hillColors },
+  { GROUND_TOP, GROUND_HEIGHT, 0, 8, groundSkyline, groundColors },
+};
+
+// Shade of the pipe row `d` pixels away from the gap: a dark rim, a light
+// cap, then the body with a dark ring every 6 rows
+static constexpr uint16_t pipeShade(int d) {
+  return (d == 0 || d == 4) ? PIPE_COLOR_DARK :
+         d < 4 ? PIPE_COLOR_LIGHT :
+         (d % 6 == 4) ? PIPE_COLOR_DARK : PIPE_COLOR_BODY;
+}
+
+// Sky fades from deep blue at the top to pale at the horizon
+static constexpr uint16_t skyShade(int y) {
+  return (uint16_t)(((6 + 14 * y / FRAMEBUFFER_HEIGHT) << 11) |
+                    ((28 + 24 * y / FRAMEBUFFER_HEIGHT) << 5) |
+                    (25 + 5 * y / FRAMEBUFFER_HEIGHT));
+}
+
+// One entry per screen row, built by the compiler
+template <int... Y>
+constexpr SpriteTable<sizeof...(Y)> skyTable(spritegen::Seq<Y...>) {
+  return {{ skyShade(Y)... }};
+}
+template <int... Y>
+constexpr SpriteTable<sizeof...(Y)> pipeShadeTable(spritegen::Seq<Y...>) {
+  return {{ pipeShade(Y)... }};
+}
+static constexpr SpriteTable<FRAMEBUFFER_HEIGHT> skyColors =
+  skyTable(spritegen::MakeSeq<FRAMEBUFFER_HEIGHT>::type());
+static constexpr SpriteTable<FRAMEBUFFER_HEIGHT> pipeShades = // By distance from the gap
+  pipeShadeTable(spritegen::MakeSeq<FRAMEBUFFER_HEIGHT>::type());
+
 // Bird sprite (8x8)
-static const uint16_t PROGMEM birdSprite[] = {
+static constexpr uint16_t PROGMEM birdBitmap[] = {
   BLACK, YELLOW, YELLOW, YELLOW, YELLOW, YELLOW, BLACK, BLACK,
   YELLOW, YELLOW, YELLOW, YELLOW, YELLOW, YELLOW, YELLOW, BLACK,
   YELLOW, YELLOW, YELLOW, YELLOW, YELLOW, YELLOW, YELLOW, YELLOW,
@@ -53,7 +132,11 @@ static const uint16_t PROGMEM birdSprite[] = {
   BLACK, BLACK, YELLOW, BLACK, BLACK, BLACK, BLACK, BLACK
 };
 
-class FlappyBird {
+// Black pixels are transparent so the bird never paints over pipes
+static constexpr SpriteTable<BIRD_HEIGHT> birdMasks = keyedSpriteMasks<BIRD_WIDTH, BIRD_HEIGHT>(birdBitmap, BLACK);
+static constexpr Sprite birdSprite = { BIRD_WIDTH, BIRD_HEIGHT, birdBitmap, birdMasks.v };
+
+class FlappyBird : public Game {
 public:
   enum GameState {
     START,
@@ -61,47 +144,50 @@ public:
     GAME_OVER
   };
   
-  FlappyBird(Adafruit_ST7735 &display, int buttonPin, int vibrationPin, int xPin, int yPin) : 
-    tft(display), buttonPin(buttonPin), vibrationPin(vibrationPin), xPin(xPin), yPin(yPin) {
+  explicit FlappyBird(FrameBuffer &display) : 
+    tft(display), motor(Vibrationmotor_PIN),
+    scene(skyColors.v), hud(SCORE_BOX_WIDTH, SCORE_BOX_HEIGHT) {
+    scene.setLayers(flappyLayers, sizeof(flappyLayers) / sizeof(flappyLayers[0]));
+    scene.setOverlay(&hud, SCORE_BOX_X, SCORE_BOX_Y, WHITE);
     currentState = START;
     gameOverScreenShown = false;
     buttonWasPressed = false;
+    menuRequested = false;
     score = 0;
     highScore = 0;
     lastFrameTime = 0;
   }
   
-  void init() {
+  void init() override {
     currentState = START;
     gameOverScreenShown = false;
+    menuRequested = false;
     score = 0;
     prevScore = 0;
+    scrollX = 0;
+    drawScore();
     
     bird.x = 30;
     bird.y = SCREEN_HEIGHT / 2;
+    bird.prevX = bird.x;
+    bird.prevY = bird.y;
     bird.velocity = 0;
+    drawnY = bird.y.toInt();
     
     for (int i = 0; i < MAX_PIPES; i++) {
       pipes[i].x = SCREEN_WIDTH + (i * (SCREEN_WIDTH / 2));
       pipes[i].gapY = random(PIPE_GAP, SCREEN_HEIGHT - PIPE_GAP);
       pipes[i].passed = false;
-      pipes[i].needsUpdate = true;
     }
     
-    tft.fillScreen(BLACK);
+    // The start screen sits on the scene, so starting only redraws the text
+    composeScene(drawnY);
     drawStartScreen();
   }
   
-  void update(bool buttonPressed, bool buttonReleased) {
-    static unsigned long lastFrameTime = 0;
-    const unsigned long frameInterval = 1000 / 60; // 60 FPS
+  void update(unsigned long, InputHandler &input) override {
+    bool buttonPressed = input.buttonPressed;
     
-    unsigned long currentTime = millis();
-    if (currentTime - lastFrameTime < frameInterval) {
-      return; // Skip frame if not enough time has passed
-    }
-    lastFrameTime = currentTime;
-
     switch (currentState) {
       case START:
         handleStartState(buttonPressed);
@@ -110,41 +196,75 @@ public:
         handlePlayingState(buttonPressed);
         break;
       case GAME_OVER:
-        handleGameOverState(buttonPressed);
+        handleGameOverState(input);
         break;
     }
   }
   
+  // The whole playfield is composed line by line here, with the bird at
+  // its position interpolated between the last two steps. Only pixels that
+  // changed since the last compose reach the display.
+  void render(Fixed8 alpha) override {
+    if (currentState != PLAYING) return;
+    
+    int y = (bird.prevY + (bird.y - bird.prevY) * alpha).toInt();
+    if (y == drawnY && !bird.needsUpdate) return;
+    
+    composeScene(y);
+    drawnY = y;
+    bird.needsUpdate = false;
+  }
+  
+  bool wantsMenu() const override { return menuRequested; }
+  
   GameState getState() { return currentState; }
   
 private:
-  Adafruit_ST7735 &tft;
-  int buttonPin, vibrationPin, xPin, yPin;
+  FrameBuffer &tft;
+  VibrationMotor motor;
   GameState currentState;
   bool gameOverScreenShown, buttonWasPressed;
+  GameOverInput gameOverInput;
+  bool menuRequested;
   Bird bird;
+  int drawnY; // Where render() last drew the bird
   Pipe pipes[MAX_PIPES];
+  LineCompositor scene;
+  GFXcanvas1 hud; // Score text, composed on top of the scene
+  int scrollX;    // Pixels the pipes have moved since init()
   int score, prevScore, highScore;
   unsigned long lastFrameTime;
   
+  void composeScene(int birdY) {
+    for (int i = 0; i < MAX_PIPES; i++) {
+      int gapTop = pipes[i].gapY - PIPE_GAP/2;
+      int gapBottom = pipes[i].gapY + PIPE_GAP/2;
+      scene.addStrip(pipes[i].x, PIPE_WIDTH, 0, gapTop, pipeShades.v, gapTop - 1);
+      scene.addStrip(pipes[i].x, PIPE_WIDTH, gapBottom, SCREEN_HEIGHT, pipeShades.v, gapBottom);
+    }
+    scene.addSprite(bird.x, birdY, birdSprite);
+    scene.setScroll(scrollX);
+    scene.compose(tft);
+  }
+  
   void handleStartState(bool buttonPressed) {
     if (buttonPressed) {
       currentState = PLAYING;
-      tft.fillScreen(BLACK);
+      bird.needsUpdate = true; // The first compose paints over the start screen
     }
   }
   
   void handlePlayingState(bool buttonPressed) {
     // Physics update
-    bird.velocity += GRAVITY;
+    bird.velocity += BIRD_GRAVITY;
     if (buttonPressed && !buttonWasPressed) {
-      bird.velocity = -JUMP_FORCE;
+      bird.velocity = -BIRD_JUMP_FORCE;
       buttonWasPressed = true;
     } else if (!buttonPressed) {
       buttonWasPressed = false;
     }
     
-    float newY = bird.y + bird.velocity;
+    Fixed8 newY = bird.y + bird.velocity;
     if (newY < 0) {
       newY = 0;
       bird.velocity = 0;
@@ -154,65 +274,29 @@ private:
       return;
     }
     
-    // Store previous position and update flag if position changed
+    // Keep the previous position for render() to interpolate from
     bird.prevX = bird.x;
     bird.prevY = bird.y;
     bird.y = newY;
-    bird.needsUpdate = (bird.prevY != bird.y);
-    
-    // Only update if position changed
-    if (bird.needsUpdate) {
-      clearBirdRegion();
-      drawBird();
-    }
     
-    // Update and draw pipes
+    // Move pipes and background; render() draws them
     updatePipes();
+    scrollX += 2;
+    bird.needsUpdate = true;
     
-    // Update score if needed
     if (prevScore != score) {
       drawScore();
       prevScore = score;
     }
   }
   
-  void clearBirdRegion() {
-    if (bird.needsUpdate) {
-      // Only clear the previous position
-      tft.fillRect(bird.prevX, bird.prevY, BIRD_WIDTH, BIRD_HEIGHT, BLACK);
-    }
-  }
-  
-  void drawBird() {
-    tft.drawRGBBitmap(bird.x, bird.y, birdSprite, BIRD_WIDTH, BIRD_HEIGHT);
-  }
-  
   void updatePipes() {
     for (int i = 0; i < MAX_PIPES; i++) {
-      // Store previous position
       pipes[i].prevX = pipes[i].x;
-      pipes[i].prevTopHeight = pipes[i].gapY - PIPE_GAP/2;
-      pipes[i].prevBottomY = pipes[i].gapY + PIPE_GAP/2;
-      
-      // Move pipe
       pipes[i].x -= 2;
       
-      // Only mark for update if position changed
-      pipes[i].needsUpdate = (pipes[i].prevX != pipes[i].x);
-      
-      if (pipes[i].needsUpdate) {
-        // Clear previous pipe edges
-        clearPipeEdges(i);
-        // Draw new pipe edges
-        drawPipe(i);
-        pipes[i].needsUpdate = false;
-      }
-      
-      // Reset pipe if off screen with proper spacing
+      // Reset pipe once it has scrolled off screen, with proper spacing
       if (pipes[i].x < -PIPE_WIDTH) {
-        // Clear the entire pipe before resetting
-        tft.fillRect(pipes[i].x, 0, PIPE_WIDTH, SCREEN_HEIGHT, BLACK);
-        
         // Find the pipe with maximum x position to ensure proper spacing
         int maxX = 0;
         for (int j = 0; j < MAX_PIPES; j++) {
@@ -237,25 +321,6 @@ private:
     }
   }
   
-  void clearPipeEdges(int index) {
-    // Clear all edges of the pipe at previous position
-    // Clear left edge
-    tft.drawFastVLine(pipes[index].prevX, 0,
-                    pipes[index].prevTopHeight, BLACK); // Top pipe left
-    tft.drawFastVLine(pipes[index].prevX, pipes[index].prevBottomY,
-                    SCREEN_HEIGHT - pipes[index].prevBottomY, BLACK); // Bottom pipe left
-    
-    // Clear right edge
-    tft.drawFastVLine(pipes[index].prevX + PIPE_WIDTH - 1, 0,
-                    pipes[index].prevTopHeight, BLACK); // Top pipe right
-    tft.drawFastVLine(pipes[index].prevX + PIPE_WIDTH - 1, pipes[index].prevBottomY,
-                    SCREEN_HEIGHT - pipes[index].prevBottomY, BLACK); // Bottom pipe right
-    
-    // Clear top and bottom edges
-    tft.drawFastHLine(pipes[index].prevX, pipes[index].prevTopHeight - 1, PIPE_WIDTH, BLACK);
-    tft.drawFastHLine(pipes[index].prevX, pipes[index].prevBottomY, PIPE_WIDTH, BLACK);
-  }
-  
   bool checkCollision(int pipeIndex) {
     if (bird.x + BIRD_WIDTH > pipes[pipeIndex].x && 
         bird.x < pipes[pipeIndex].x + PIPE_WIDTH) {
@@ -267,54 +332,39 @@ private:
     return false;
   }
   
-  void drawPipe(int index) {
-    // Draw 1px edges of the pipe
-    // Draw leading and trailing edges of top pipe
-    tft.drawFastVLine(pipes[index].x, 0,
-                    pipes[index].gapY - PIPE_GAP/2, GREEN); // Leading edge
-    tft.drawFastVLine(pipes[index].x + PIPE_WIDTH - 1, 0,
-                    pipes[index].gapY - PIPE_GAP/2, GREEN); // Trailing edge
-    
-    // Draw leading and trailing edges of bottom pipe
-    tft.drawFastVLine(pipes[index].x, pipes[index].gapY + PIPE_GAP/2,
-                    SCREEN_HEIGHT - (pipes[index].gapY + PIPE_GAP/2), GREEN); // Leading edge
-    tft.drawFastVLine(pipes[index].x + PIPE_WIDTH - 1, pipes[index].gapY + PIPE_GAP/2,
-                    SCREEN_HEIGHT - (pipes[index].gapY + PIPE_GAP/2), GREEN); // Trailing edge
-    
-    // Draw top and bottom edges for better visibility
-    tft.drawFastHLine(pipes[index].x, pipes[index].gapY - PIPE_GAP/2 - 1, PIPE_WIDTH, GREEN);
-    tft.drawFastHLine(pipes[index].x, pipes[index].gapY + PIPE_GAP/2, PIPE_WIDTH, GREEN);
-  }
-  
   void gameOver() {
     currentState = GAME_OVER;
-    digitalWrite(vibrationPin, HIGH);
-    delay(200);
-    digitalWrite(vibrationPin, LOW);
+    gameOverInput.reset();
+    motor.pulse(200);
   }
   
-  void handleGameOverState(bool buttonPressed) {
+  void handleGameOverState(const InputHandler &input) {
     if (!gameOverScreenShown) {
       drawGameOverScreen();
       gameOverScreenShown = true;
       if (score > highScore) highScore = score;
     }
     
-    if (buttonPressed && !buttonWasPressed) {
-      buttonWasPressed = true;
-    } else if (!buttonPressed && buttonWasPressed) {
-      buttonWasPressed = false;
-      init();
+    switch (gameOverInput.update(input)) {
+      case GameOverInput::RESTART:
+        init();
+        break;
+      case GameOverInput::MENU:
+        menuRequested = true;
+        break;
+      case GameOverInput::NONE:
+        break;
     }
   }
   
+  // Render the score into the HUD overlay; it shows at the next compose
   void drawScore() {
-    tft.fillRect(5, 5, 50, 10, BLACK);
-    tft.setTextColor(WHITE);
-    tft.setTextSize(1);
-    tft.setCursor(5, 5);
-    tft.print("Score: ");
-    tft.print(score);
+    hud.fillScreen(0);
+    hud.setTextColor(1);
+    hud.setTextSize(1);
+    hud.setCursor(0, 0);
+    hud.print("Score: ");
+    hud.print(score);
   }
   
   void drawStartScreen() {
@@ -326,7 +376,6 @@ private:
     tft.print("Press button");
     tft.setCursor(25, 70);
     tft.print("to start");
-    drawBird();
   }
   
   void drawGameOverScreen() {
@@ -345,6 +394,8 @@ private:
     tft.print("Press button");
     tft.setCursor(15, 100);
     tft.print("to play again");
+    tft.setCursor(15, 112);
+    tft.print("Hold for menu");
   }
 };
 
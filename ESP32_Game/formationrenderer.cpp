@@ -0,0 +1,118 @@
+#include "formationrenderer.h"
+
+FormationRenderer::FormationRenderer(const uint8_t *sprite, uint8_t height, uint8_t spacingX,
+                                     uint16_t color, uint16_t background) :
+  height(min(height, (uint8_t)FORMATION_SPRITE_MAX_HEIGHT)), spacingX(spacingX), color(color),
+  background(background) {
+  // Bitmaps store the leftmost pixel in the top bit; flip each line so
+  // pixel i is bit i like the scanline words
+  for (int l = 0; l < this->height; l++) {
+    uint8_t b = pgm_read_byte(&sprite[l]);
+    uint8_t reversed = 0;
+    for (int i = 0; i < 8; i++) {
+      if (b & (0x80 >> i)) reversed |= 1 << i;
+    }
+    lines[l] = reversed;
+  }
+  reset();
+}
+
+void FormationRenderer::reset() {
+  memset(shown, 0, sizeof(shown));
+  shownTop = shownBottom = 0;
+}
+
+void FormationRenderer::invalidate(int x, int y, int w, int h) {
+  int left = max(x, 0), right = min(x + w, FRAMEBUFFER_WIDTH);
+  int top = max(y, 0), bottom = min(y + h, FRAMEBUFFER_HEIGHT);
+  if (right <= left) return;
+
+  // The columns as a mask per scanline word
+  uint32_t mask[FORMATION_LINE_WORDS];
+  for (int word = 0; word < FORMATION_LINE_WORDS; word++) {
+    int from = max(left - word * 32, 0), to = min(right - word * 32, 32);
+    if (to <= from) {
+      mask[word] = 0;
+    } else {
+      uint32_t below = to == 32 ? ~0u : (1u << to) - 1;
+      mask[word] = below & ~((1u << from) - 1);
+    }
+  }
+  for (int line = top; line < bottom; line++) {
+    for (int word = 0; word < FORMATION_LINE_WORDS; word++) {
+      shown[line][word] &= ~mask[word];
+    }
+  }
+}
+
+void FormationRenderer::orPattern(uint32_t *line, int x, uint8_t bits) {
+  if (x < 0) {
+    if (x <= -8) return;
+    bits >>= -x;
+    x = 0;
+  }
+  if (x >= FRAMEBUFFER_WIDTH) return;
+
+  int word = x >> 5, shift = x & 31;
+  line[word] |= (uint32_t)bits << shift;
+  if (shift > 24 && word + 1 < FORMATION_LINE_WORDS) {
+    line[word + 1] |= (uint32_t)bits >> (32 - shift);
+  }
+}
+
+void FormationRenderer::drawRuns(FrameBuffer &fb, int x, int y, uint32_t bits, uint16_t color) {
+  while (bits) {
+    int start = __builtin_ctz(bits);
+    uint32_t rest = ~(bits >> start);
+    int length = rest ? __builtin_ctz(rest) : 32 - start;
+    fb.fillSpan(x + start, y, length, color);
+
+    if (start + length >= 32) break;
+    bits &= ~(((1u << length) - 1) << start);
+  }
+}
+
+void FormationRenderer::draw(FrameBuffer &fb, const int16_t *rowX, const int16_t *rowY,
+                             const uint16_t *rows, int rowCount) {
+  // Scanlines the live rows cover now
+  int newTop = FRAMEBUFFER_HEIGHT, newBottom = 0;
+  for (int r = 0; r < rowCount; r++) {
+    if (!rows[r]) continue;
+    newTop = min(newTop, max(0, (int)rowY[r]));
+    newBottom = max(newBottom, min(FRAMEBUFFER_HEIGHT, rowY[r] + height));
+  }
+  if (newBottom <= newTop) newTop = newBottom = 0;
+
+  // Scanlines covered now or at the last draw
+  int top = shownTop, bottom = shownBottom;
+  if (bottom <= top) {
+    top = newTop;
+    bottom = newBottom;
+  } else if (newBottom > newTop) {
+    top = min(top, newTop);
+    bottom = max(bottom, newBottom);
+  }
+
+  for (int y = top; y < bottom; y++) {
+    uint32_t line[FORMATION_LINE_WORDS] = {0};
+
+    for (int r = 0; r < rowCount; r++) {
+      int l = y - rowY[r];
+      if (l < 0 || l >= height) continue;
+      for (uint16_t mask = rows[r]; mask; mask &= mask - 1) {
+        orPattern(line, rowX[r] + __builtin_ctz(mask) * spacingX, lines[l]);
+      }
+    }
+
+    for (int w = 0; w < FORMATION_LINE_WORDS; w++) {
+      uint32_t changed = shown[y][w] ^ line[w];
+      if (!changed) continue;
+      drawRuns(fb, w * 32, y, changed & line[w], color);
+      drawRuns(fb, w * 32, y, changed & shown[y][w], background);
+      shown[y][w] = line[w];
+    }
+  }
+
+  shownTop = newTop;
+  shownBottom = newBottom;
+}
@@ -0,0 +1,48 @@
+#ifndef FORMATIONRENDERER_H
+#define FORMATIONRENDERER_H
+
+#include "framebuffer.h"
+
+#define FORMATION_SPRITE_MAX_HEIGHT 8
+#define FORMATION_LINE_WORDS (FRAMEBUFFER_WIDTH / 32)
+
+// Draws a grid of identical 1-bit sprites (at most 8 pixels wide) by
+// difference. It keeps a 1-bit copy of what it last put on screen; draw()
+// rebuilds each scanline of the formation from the row masks and only
+// writes the runs of pixels that changed, each as its own dirty span. A
+// one-pixel shift then touches the sprite edges instead of erasing and
+// redrawing every sprite, and a killed sprite is just a cleared bit.
+// Each row has its own origin, so rows can step one at a time.
+class FormationRenderer {
+public:
+  FormationRenderer(const uint8_t *sprite, uint8_t height, uint8_t spacingX, uint16_t color,
+                    uint16_t background);
+
+  // Forget what is on screen, e.g. after it was cleared
+  void reset();
+
+  // Forget a rectangle after something else drew over it; the next draw()
+  // repaints every sprite pixel in it
+  void invalidate(int x, int y, int w, int h);
+
+  // Takes effect at the next draw(), which moves the sprites by difference
+  void setSpacing(uint8_t x) { spacingX = x; }
+
+  // rows[r] has bit c set for each live sprite at (rowX[r] + c * spacingX, rowY[r]).
+  // Rows must not overlap.
+  void draw(FrameBuffer &fb, const int16_t *rowX, const int16_t *rowY, const uint16_t *rows,
+            int rowCount);
+
+private:
+  static void orPattern(uint32_t *line, int x, uint8_t bits);
+  static void drawRuns(FrameBuffer &fb, int x, int y, uint32_t bits, uint16_t color);
+
+  uint8_t lines[FORMATION_SPRITE_MAX_HEIGHT]; // Sprite lines, bit 0 leftmost
+  uint8_t height, spacingX;
+  uint16_t color, background;
+
+  uint32_t shown[FRAMEBUFFER_HEIGHT][FORMATION_LINE_WORDS];
+  int16_t shownTop, shownBottom; // Scanlines holding set bits, bottom exclusive
+};
+
+#endif
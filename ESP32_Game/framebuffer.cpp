@@ -0,0 +1,153 @@
+#include "framebuffer.h"
+
+FrameBuffer::FrameBuffer(DisplayBackend &backend) :
+  Adafruit_GFX(FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT), backend(&backend) {
+  memset(buffer, 0, sizeof(buffer));
+  resetStats();
+}
+
+void FrameBuffer::resetStats() {
+  flushStats.drawCalls = 0;
+  flushStats.windowsOpened = 0;
+  flushStats.pixelsPushed = 0;
+  flushStats.stallUs = 0;
+}
+
+bool FrameBuffer::clip(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const {
+  if (w < 0) { x += w + 1; w = -w; }
+  if (h < 0) { y += h + 1; h = -h; }
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > FRAMEBUFFER_WIDTH) w = FRAMEBUFFER_WIDTH - x;
+  if (y + h > FRAMEBUFFER_HEIGHT) h = FRAMEBUFFER_HEIGHT - y;
+  return w > 0 && h > 0;
+}
+
+void FrameBuffer::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  flushStats.drawCalls++;
+  if (x < 0 || y < 0 || x >= FRAMEBUFFER_WIDTH || y >= FRAMEBUFFER_HEIGHT) return;
+
+  buffer[y * FRAMEBUFFER_WIDTH + x] = color;
+  dirty.add(x, y, 1, 1);
+}
+
+void FrameBuffer::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  flushStats.drawCalls++;
+  if (!clip(x, y, w, h)) return;
+
+  for (int16_t row = y; row < y + h; row++) {
+    uint16_t *dst = &buffer[row * FRAMEBUFFER_WIDTH + x];
+    for (int16_t i = 0; i < w; i++) {
+      dst[i] = color;
+    }
+  }
+  dirty.add(x, y, w, h);
+}
+
+void FrameBuffer::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void FrameBuffer::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void FrameBuffer::fillSpan(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  flushStats.drawCalls++;
+  int16_t h = 1;
+  if (!clip(x, y, w, h)) return;
+
+  uint16_t *dst = &buffer[y * FRAMEBUFFER_WIDTH + x];
+  for (int16_t i = 0; i < w; i++) {
+    dst[i] = color;
+  }
+  dirty.addSpan(x, y, w);
+}
+
+void FrameBuffer::fillScreen(uint16_t color) {
+  fillRect(0, 0, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT, color);
+}
+
+void FrameBuffer::drawSprite(int16_t x, int16_t y, const Sprite &sprite) {
+  flushStats.drawCalls++;
+  int16_t cx = x, cy = y, w = sprite.width, h = sprite.height;
+  if (!clip(cx, cy, w, h)) return;
+
+  int16_t skip = cx - x; // Columns clipped off the left
+  uint16_t visible = (uint16_t)((1u << w) - 1);
+  for (int16_t row = cy - y; row < cy - y + h; row++) {
+    const uint16_t *src = &sprite.pixels[row * sprite.width + skip];
+    uint16_t *dst = &buffer[(y + row) * FRAMEBUFFER_WIDTH + cx];
+
+    uint16_t mask = (sprite.rowMasks[row] >> skip) & visible;
+    if (mask == visible) {
+      memcpy(dst, src, w * sizeof(uint16_t));
+      continue;
+    }
+    while (mask) {
+      int start = __builtin_ctz(mask);
+      int length = __builtin_ctz(~(mask >> start)); // mask is 16 bits, so this ends
+      memcpy(&dst[start], &src[start], length * sizeof(uint16_t));
+      mask &= ~(((1u << length) - 1) << start);
+    }
+  }
+  dirty.add(cx, cy, w, h);
+}
+
+void FrameBuffer::scrollRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t dx, int16_t dy) {
+  flushStats.drawCalls++;
+  if (!clip(x, y, w, h)) return;
+
+  int16_t cols = w - abs(dx), rows = h - abs(dy);
+  if (cols > 0 && rows > 0) {
+    int16_t srcX = dx < 0 ? x - dx : x, dstX = dx < 0 ? x : x + dx;
+    int16_t srcY = dy < 0 ? y - dy : y, dstY = dy < 0 ? y : y + dy;
+    // Copy rows in the order that doesn't overwrite ones still to be moved.
+    // Only the runs the move actually changes are marked dirty, so the
+    // empty background of a scrolled view costs nothing to flush.
+    uint16_t line[FRAMEBUFFER_WIDTH];
+    for (int16_t i = 0; i < rows; i++) {
+      int16_t row = dy > 0 ? rows - 1 - i : i;
+      const uint16_t *src = &buffer[(srcY + row) * FRAMEBUFFER_WIDTH + srcX];
+      if (dx != 0) {
+        // Source and destination share the row; take a copy first
+        memcpy(line, src, cols * sizeof(uint16_t));
+        src = line;
+      }
+      copyRuns(dstX, dstY + row, src, cols);
+    }
+  }
+}
+
+void FrameBuffer::writeRow(int16_t y, const uint16_t *line) {
+  flushStats.drawCalls++;
+  if (y < 0 || y >= FRAMEBUFFER_HEIGHT) return;
+
+  copyRuns(0, y, line, FRAMEBUFFER_WIDTH);
+}
+
+void FrameBuffer::copyRuns(int16_t x, int16_t y, const uint16_t *src, int16_t w) {
+  uint16_t *dst = &buffer[y * FRAMEBUFFER_WIDTH + x];
+  int16_t i = 0;
+  while (i < w) {
+    while (i < w && dst[i] == src[i]) i++;
+    if (i == w) return;
+
+    int16_t start = i;
+    while (i < w && dst[i] != src[i]) {
+      dst[i] = src[i];
+      i++;
+    }
+    dirty.addSpan(x + start, y, i - start);
+  }
+}
+
+void FrameBuffer::setBackend(DisplayBackend &newBackend) {
+  backend->wait();
+  backend = &newBackend;
+}
+
+void FrameBuffer::flush() {
+  backend->push(buffer, dirty, flushStats);
+  dirty.clear();
+}
@@ -0,0 +1,62 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <Adafruit_GFX.h>
+#include "dirtyregion.h"
+#include "displaybackend.h"
+#include "sprite.h"
+
+// Off-screen RGB565 canvas the games draw into.
+// Every primitive only touches RAM and records its bounds; flush() then
+// streams the dirty rectangles to the display backend in a few bulk bursts.
+class FrameBuffer : public Adafruit_GFX {
+public:
+  FrameBuffer(DisplayBackend &backend);
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+
+  // Fill w pixels of row y, marked dirty as a span of its own rather than
+  // merged with the rectangles; for callers that only touch changed pixels
+  void fillSpan(int16_t x, int16_t y, int16_t w, uint16_t color);
+
+  // Copy the opaque runs of a pre-converted sprite; one dirty rect per call
+  void drawSprite(int16_t x, int16_t y, const Sprite &sprite);
+
+  // Move the contents of a rectangle by (dx, dy) within it; the strip
+  // left uncovered keeps its old pixels for the caller to redraw. Only
+  // runs of pixels the move changes are marked dirty.
+  void scrollRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t dx, int16_t dy);
+
+  // Replace row y with a full-width line; each run of pixels that differs
+  // from what the row held is marked dirty as a span of its own
+  void writeRow(int16_t y, const uint16_t *line);
+
+  // Push all dirty rectangles and spans to the display and clear them
+  void flush();
+
+  DisplayBackend &getBackend() { return *backend; }
+  void setBackend(DisplayBackend &newBackend);
+
+  uint16_t *getBuffer() { return buffer; }
+  const DirtyRegion &dirtyRegion() const { return dirty; }
+  void clearDirty() { dirty.clear(); }
+  const FlushStats &stats() const { return flushStats; }
+  void resetStats();
+
+private:
+  bool clip(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const;
+
+  // Copy w pixels over row y from x on; one dirty span per changed run
+  void copyRuns(int16_t x, int16_t y, const uint16_t *src, int16_t w);
+
+  DisplayBackend *backend;
+  uint16_t buffer[FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT];
+  DirtyRegion dirty;
+  FlushStats flushStats;
+};
+
+#endif
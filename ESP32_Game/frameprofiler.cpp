@@ -0,0 +1,119 @@
+#include "frameprofiler.h"
+#include <algorithm>
+
+FrameProfiler::FrameProfiler(FrameBuffer &frameBuffer, const LoopStats &loopStats, Print &out,
+                             unsigned long (*clock)()) :
+  frameBuffer(frameBuffer), loopStats(loopStats), out(out), clock(clock), windowLabel(nullptr),
+  windowStart(loopStats), frameStats(loopStats), frameStart(0), frameCount(0) {
+  resetWindow(loopStats);
+}
+
+void FrameProfiler::beginFrame() {
+  frameBuffer.resetStats();
+  frameStats = loopStats;
+  frameStart = clock();
+}
+
+void FrameProfiler::endFrame(const char *label) {
+  uint32_t frameTime = clock() - frameStart;
+
+  // A window covers one label; the frame that switches starts a new one
+  if (frameCount > 0 && strcmp(label, windowLabel) != 0) {
+    report(frameStats);
+    resetWindow(frameStats);
+  }
+  windowLabel = label;
+  frameTimes[frameCount++] = frameTime;
+
+  const FlushStats &stats = frameBuffer.stats();
+  uint32_t spiBytes = stats.pixelsPushed * 2 + stats.windowsOpened * ADDR_WINDOW_BYTES;
+  totalPixels += stats.pixelsPushed;
+  totalDrawCalls += stats.drawCalls;
+  totalWindows += stats.windowsOpened;
+  totalSpiBytes += spiBytes;
+  maxPixels = max(maxPixels, stats.pixelsPushed);
+  maxDrawCalls = max(maxDrawCalls, stats.drawCalls);
+  maxWindows = max(maxWindows, stats.windowsOpened);
+  maxSpiBytes = max(maxSpiBytes, spiBytes);
+  totalStallUs += stats.stallUs;
+  maxStallUs = max(maxStallUs, stats.stallUs);
+
+  if (frameCount == PROFILE_WINDOW) {
+    report(loopStats);
+    resetWindow(loopStats);
+  }
+}
+
+void FrameProfiler::flush() {
+  if (frameCount == 0) return;
+  report(loopStats);
+  resetWindow(loopStats);
+}
+
+void FrameProfiler::resetWindow(const LoopStats &windowBegin) {
+  windowStart = windowBegin;
+  frameCount = 0;
+  totalPixels = maxPixels = 0;
+  totalDrawCalls = maxDrawCalls = 0;
+  totalWindows = maxWindows = 0;
+  totalSpiBytes = maxSpiBytes = 0;
+  totalStallUs = maxStallUs = 0;
+}
+
+void FrameProfiler::benchmark(const char *label, void (*draw)(FrameBuffer &, int), int iterations) {
+  frameBuffer.resetStats();
+  uint32_t pixels = 0, windows = 0;
+  unsigned long elapsed = 0;
+  for (int i = 0; i < iterations; i++) {
+    unsigned long start = clock();
+    draw(frameBuffer, i);
+    elapsed += clock() - start;
+
+    // What a flush after this call would have pushed
+    pixels += frameBuffer.dirtyRegion().area();
+    windows += frameBuffer.dirtyRegion().windowCount();
+    frameBuffer.clearDirty();
+  }
+
+  out.print("{\"bench\":\""); out.print(label);
+  out.print("\",\"iterations\":"); out.print(iterations);
+  out.print(",\"us\":"); out.print(elapsed);
+  out.print(",\"drawCalls\":"); out.print(frameBuffer.stats().drawCalls);
+  out.print(",\"pixels\":"); out.print(pixels);
+  out.print(",\"windows\":"); out.print(windows);
+  out.println("}");
+
+  // Nothing drawn here is meant for the screen
+  frameBuffer.resetStats();
+}
+
+uint32_t FrameProfiler::percentile(int pct) const {
+  // frameTimes is sorted by report()
+  int index = (frameCount - 1) * pct / 100;
+  return frameTimes[index];
+}
+
+void FrameProfiler::report(const LoopStats &windowEnd) {
+  std::sort(frameTimes, frameTimes + frameCount);
+
+  out.print("{\"label\":\""); out.print(windowLabel);
+  out.print("\",\"frames\":"); out.print(frameCount);
+  out.print(",\"us\":{\"p50\":"); out.print(percentile(50));
+  out.print(",\"p95\":"); out.print(percentile(95));
+  out.print(",\"p99\":"); out.print(percentile(99));
+  out.print(",\"max\":"); out.print(frameTimes[frameCount - 1]);
+  out.print("},\"pixels\":{\"total\":"); out.print(totalPixels);
+  out.print(",\"max\":"); out.print(maxPixels);
+  out.print("},\"drawCalls\":{\"total\":"); out.print(totalDrawCalls);
+  out.print(",\"max\":"); out.print(maxDrawCalls);
+  out.print("},\"windows\":{\"total\":"); out.print(totalWindows);
+  out.print(",\"max\":"); out.print(maxWindows);
+  out.print("},\"spiBytes\":{\"total\":"); out.print(totalSpiBytes);
+  out.print(",\"max\":"); out.print(maxSpiBytes);
+  out.print("},\"stallUs\":{\"total\":"); out.print(totalStallUs);
+  out.print(",\"max\":"); out.print(maxStallUs);
+  out.print("},\"sim\":{\"steps\":"); out.print(windowEnd.steps - windowStart.steps);
+  out.print(",\"late\":"); out.print(windowEnd.lateFrames - windowStart.lateFrames);
+  out.print(",\"dropped\":"); out.print(windowEnd.droppedSteps - windowStart.droppedSteps);
+  out.println("}}");
+}
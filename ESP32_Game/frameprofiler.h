@@ -0,0 +1,65 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <Arduino.h>
+#include "framebuffer.h"
+#include "gameloop.h"
+
+#ifndef FRAME_PROFILE
+#define FRAME_PROFILE 0 // Set to 1 to stream frame timings over Serial
+#endif
+
+#ifndef PROFILE_WINDOW
+#define PROFILE_WINDOW 512 // Frames per report
+#endif
+
+// Measures loop iterations and the framebuffer flush cost of each one.
+// A window of frames is reported as one JSON line when it reaches
+// PROFILE_WINDOW frames or when the label changes, so every line covers
+// one screen and two runs of the same input can be diffed to spot
+// regressions in the draw paths. The line also carries the SPI bytes the
+// flushes cost and the simulation steps, late frames and dropped steps
+// the fixed-step loop counted over the window. Times come from clock,
+// micros() unless a host harness passes a wall clock.
+class FrameProfiler {
+public:
+  FrameProfiler(FrameBuffer &frameBuffer, const LoopStats &loopStats, Print &out,
+                unsigned long (*clock)() = micros);
+
+  void beginFrame();
+  void endFrame(const char *label);
+
+  // Report the frames of an unfinished window
+  void flush();
+
+  // Time `iterations` calls of draw(frameBuffer, i) and print one JSON
+  // line with the draw calls made and the dirty pixels a flush after each
+  // call would push; for comparing draw paths
+  void benchmark(const char *label, void (*draw)(FrameBuffer &, int), int iterations);
+
+private:
+  void report(const LoopStats &windowEnd);
+  void resetWindow(const LoopStats &windowBegin);
+  uint32_t percentile(int pct) const;
+
+  FrameBuffer &frameBuffer;
+  const LoopStats &loopStats;
+  Print &out;
+  unsigned long (*clock)();
+
+  const char *windowLabel; // Label of the frames in the window
+  LoopStats windowStart;   // loopStats when the window began
+  LoopStats frameStats;    // loopStats when the current frame began
+
+  unsigned long frameStart;
+  uint32_t frameTimes[PROFILE_WINDOW];
+  int frameCount;
+
+  uint32_t totalPixels, maxPixels;
+  uint32_t totalDrawCalls, maxDrawCalls;
+  uint32_t totalWindows, maxWindows;
+  uint32_t totalSpiBytes, maxSpiBytes;
+  uint32_t totalStallUs, maxStallUs;
+};
+
+#endif
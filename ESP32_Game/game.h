@@ -0,0 +1,58 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "fixedpoint.h"
+#include "inputhandler.h"
+
+// Common interface for everything the menu can launch.
+// Games draw into the shared FrameBuffer; the console flushes it.
+class Game {
+public:
+  virtual ~Game() {}
+  
+  // Reset state and draw the first screen
+  virtual void init() = 0;
+  
+  // Advance the game by one fixed simulation step of dt ms (SIM_STEP_MS).
+  // May run several times per loop() when drawing falls behind.
+  virtual void update(unsigned long dt, InputHandler &input) = 0;
+  
+  // Draw anything update() left for the end of the frame, once per loop().
+  // alpha (0..1) is how far real time is between the last step and the next.
+  virtual void render(Fixed8 alpha) = 0;
+  
+  // True once the player asked to leave for the menu; the console checks
+  // after every update()
+  virtual bool wantsMenu() const = 0;
+};
+
+// Button handling shared by the game over screens: a short press restarts
+// (on release), holding the button for BUTTON_HOLD_MS asks for the menu.
+// Only presses that start on the screen count, so a button still down
+// from play triggers neither.
+class GameOverInput {
+public:
+  enum Action { NONE, RESTART, MENU };
+
+  // Call when the game over screen appears
+  void reset() { armed = false; }
+
+  Action update(const InputHandler &input) {
+    if (input.buttonPressed) armed = true;
+    if (!armed) return NONE;
+    if (input.buttonHeld) {
+      armed = false;
+      return MENU;
+    }
+    if (input.buttonReleased) {
+      armed = false;
+      return RESTART;
+    }
+    return NONE;
+  }
+
+private:
+  bool armed = false;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "gameloop.h"
+
+FixedStepLoop::FixedStepLoop(unsigned long stepMs, uint8_t maxCatchUp) :
+  stepMs(stepMs), maxCatchUp(maxCatchUp), lastTime(0), accumulator(0) {
+  loopStats.steps = 0;
+  loopStats.lateFrames = 0;
+  loopStats.droppedSteps = 0;
+}
+
+void FixedStepLoop::reset(unsigned long nowMs) {
+  lastTime = nowMs;
+  accumulator = 0;
+}
+
+int FixedStepLoop::advance(unsigned long nowMs) {
+  accumulator += nowMs - lastTime;
+  lastTime = nowMs;
+
+  unsigned long steps = accumulator / stepMs;
+  accumulator -= steps * stepMs;
+
+  if (steps > 1) {
+    loopStats.lateFrames++;
+  }
+  if (steps > maxCatchUp) {
+    // Too far behind (e.g. a long flush): slow the game down rather than
+    // spiral trying to catch up
+    loopStats.droppedSteps += steps - maxCatchUp;
+    steps = maxCatchUp;
+  }
+
+  loopStats.steps += steps;
+  return (int)steps;
+}
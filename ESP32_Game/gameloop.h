@@ -0,0 +1,42 @@
+#ifndef GAMELOOP_H
+#define GAMELOOP_H
+
+#include <Arduino.h>
+#include "fixedpoint.h"
+
+#define SIM_STEP_MS 16 // Simulation rate (62.5 Hz, what the per-game gates used)
+#define MAX_CATCH_UP_STEPS 4 // Steps run at most per loop() before time is dropped
+
+struct LoopStats {
+  uint32_t steps;        // Simulation steps run
+  uint32_t lateFrames;   // Loops that needed more than one step
+  uint32_t droppedSteps; // Steps skipped because catch-up hit the limit
+};
+
+// Fixed-timestep accumulator.
+// Simulation always advances in SIM_STEP_MS increments, independent of how
+// long drawing and flushing take, so gameplay speed doesn't depend on the
+// frame rate. Rendering happens once per loop() with alpha() giving how
+// far real time has moved into the next step.
+class FixedStepLoop {
+public:
+  FixedStepLoop(unsigned long stepMs, uint8_t maxCatchUp);
+
+  void reset(unsigned long nowMs);
+
+  // Number of steps to simulate for the time elapsed since the last call
+  int advance(unsigned long nowMs);
+
+  // 0 to just under 1 in 1/256 steps, ready to scale fixed-point motion
+  Fixed8 alpha() const { return Fixed8::fromRaw((int32_t)(accumulator * Fixed8::ONE / stepMs)); }
+  const LoopStats &stats() const { return loopStats; }
+
+private:
+  unsigned long stepMs;
+  uint8_t maxCatchUp;
+  unsigned long lastTime;
+  unsigned long accumulator;
+  LoopStats loopStats;
+};
+
+#endif
@@ -1,23 +1,25 @@
 #include "gamemenu.h"
+#include "gameregistry.h"
 #include "inputhandler.h"
+#include "logger.h"
 #include <Arduino.h>
 
-GameMenu::GameMenu(Adafruit_ST7735 &display, InputHandler &inputHandler) : 
+GameMenu::GameMenu(FrameBuffer &display, InputHandler &inputHandler) : 
   tft(display), inputHandler(inputHandler) {}
 
 void GameMenu::init() {
     selectedItem = 0;
     currentGameIndex = -1;
     shouldLaunchGame = false; // Ensure launch state is reset
-    menuItemCount = 4; // Space Invador, Flappy Bird, Snake, and Breakout
-    menuItems[0] = "Space Invador";
-    menuItems[1] = "Flappy Bird";
-    menuItems[2] = "Snake";
-    menuItems[3] = "Breakout";
+    menuItemCount = GAME_COUNT; // One item per registered game
     tft.fillScreen(MENU_BG);
     drawMenu();
 }
 
+const char* GameMenu::itemName(int index) const {
+    return GAME_REGISTRY[index].name;
+}
+
 void GameMenu::draw() {
     static int lastSelectedItem = -1;
     static bool lastButtonState = false;
@@ -26,7 +28,7 @@ void GameMenu::draw() {
     static unsigned long lastInputTime = 0;
     static bool wasUpPressed = false;
     static bool wasDownPressed = false;
-    const unsigned long debounceDelay = 3500; // Reduced debounce time for better responsiveness
+    const unsigned long debounceDelay = 200; // Minimum time between two moves
     
     unsigned long currentTime = millis();
     if (currentTime - lastInputTime >= debounceDelay) {
@@ -34,7 +36,7 @@ void GameMenu::draw() {
         if (inputHandler.up) {
             if (!wasUpPressed) { // Transition from not pressed to pressed
                 selectedItem = max(0, selectedItem - 1);
-                Serial.println("Menu: Selected item changed to " + String(selectedItem));
+                LOG_DEBUG(LOG_MODULE_MENU, "Menu: Selected item changed to ", selectedItem);
                 lastInputTime = currentTime;
                 wasUpPressed = true;
             }
@@ -46,7 +48,7 @@ void GameMenu::draw() {
         if (inputHandler.down) {
             if (!wasDownPressed) { // Transition from not pressed to pressed
                 selectedItem = min(menuItemCount - 1, selectedItem + 1);
-                Serial.println("Menu: Selected item changed to " + String(selectedItem));
+                LOG_DEBUG(LOG_MODULE_MENU, "Menu: Selected item changed to ", selectedItem);
                 lastInputTime = currentTime;
                 wasDownPressed = true;
             }
@@ -57,7 +59,7 @@ void GameMenu::draw() {
     
     // Check if button is pressed to launch selected game
     if (inputHandler.buttonPressed) {
-        Serial.println("Menu: Button pressed, attempting to launch game " + String(selectedItem));
+        LOG_INFO(LOG_MODULE_MENU, "Menu: Button pressed, attempting to launch game ", selectedItem);
         shouldLaunchGame = true;
         currentGameIndex = selectedItem;
         // Reset input states to prevent multiple triggers
@@ -93,9 +95,9 @@ void GameMenu::drawMenu() {
         tft.setTextColor(UNSELECTED_COLOR);
         for (int i = 0; i < menuItemCount; i++) {
             int itemY = MENU_START_Y + (i * MENU_ITEM_HEIGHT);
-            int textX = (tft.width() - strlen(menuItems[i]) * 6) / 2;
+            int textX = (tft.width() - strlen(itemName(i)) * 6) / 2;
             tft.setCursor(textX, itemY + MENU_ITEM_PADDING/2);
-            tft.print(menuItems[i]);
+            tft.print(itemName(i));
         }
         
         // Reset launch state if coming from game over
@@ -112,18 +114,18 @@ void GameMenu::drawMenu() {
         int prevY = MENU_START_Y + (lastSelectedItem * MENU_ITEM_HEIGHT);
         tft.fillRoundRect(2, prevY - 2, tft.width() - 4, MENU_ITEM_HEIGHT - 4, 4, MENU_BG);
         tft.setTextColor(UNSELECTED_COLOR);
-        int textX = (tft.width() - strlen(menuItems[lastSelectedItem]) * 6) / 2;
+        int textX = (tft.width() - strlen(itemName(lastSelectedItem)) * 6) / 2;
         tft.setCursor(textX, prevY + MENU_ITEM_PADDING/2);
-        tft.print(menuItems[lastSelectedItem]);
+        tft.print(itemName(lastSelectedItem));
     }
     
     // Draw new selection
     int itemY = MENU_START_Y + (selectedItem * MENU_ITEM_HEIGHT);
     tft.fillRoundRect(2, itemY - 2, tft.width() - 4, MENU_ITEM_HEIGHT - 4, 4, SELECTOR_COLOR);
     tft.setTextColor(BLACK);
-    int textX = (tft.width() - strlen(menuItems[selectedItem]) * 6) / 2;
+    int textX = (tft.width() - strlen(itemName(selectedItem)) * 6) / 2;
     tft.setCursor(textX, itemY + MENU_ITEM_PADDING/2);
-    tft.print(menuItems[selectedItem]);
+    tft.print(itemName(selectedItem));
     
     lastSelectedItem = selectedItem;
 }
\ No newline at end of file
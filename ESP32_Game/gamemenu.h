@@ -3,9 +3,7 @@
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7735.h>
-#include "spaceinvador.h"
-#include "snake.h"
-#include "breakout.h"
+#include "framebuffer.h"
 #include "inputhandler.h"
 
 // Color definitions
@@ -31,23 +29,21 @@
 #define UNSELECTED_COLOR WHITE
 #define SELECTOR_COLOR GREEN
 
-enum GameType { SPACE_INVADOR, SNAKE, BREAKOUT };
-
 class GameMenu {
 public:
-  GameMenu(Adafruit_ST7735 &display, InputHandler &inputHandler);
+  GameMenu(FrameBuffer &display, InputHandler &inputHandler);
   void init();
   void draw();
+  const char* itemName(int index) const;
   
   int selectedItem = 0;
   bool shouldLaunchGame = false;
   int currentGameIndex = -1;
   
 private:
-  Adafruit_ST7735 &tft;
+  FrameBuffer &tft;
   InputHandler &inputHandler;
   
-  const char* menuItems[4] = {"Space Invador", "Flappy Bird", "Snake", "Breakout"};
   int menuItemCount;
   
   void drawMenu();
@@ -0,0 +1,44 @@
+#ifndef GAMEREGISTRY_H
+#define GAMEREGISTRY_H
+
+#include <type_traits>
+#include "framebuffer.h"
+#include "game.h"
+#include "inputhandler.h"
+#include "spaceinvador.h"
+#include "flappybird.h"
+#include "snakegame.h"
+#include "breakout.h"
+
+struct GameEntry {
+  const char *name;
+  Game *(*create)(FrameBuffer &display, InputHandler &input);
+};
+
+// Each game is constructed on first launch and reused afterwards. Games
+// that read input only through update() take just the display.
+template <typename T>
+typename std::enable_if<std::is_constructible<T, FrameBuffer &, InputHandler &>::value, Game *>::type
+createGame(FrameBuffer &display, InputHandler &input) {
+  static T game(display, input);
+  return &game;
+}
+
+template <typename T>
+typename std::enable_if<!std::is_constructible<T, FrameBuffer &, InputHandler &>::value, Game *>::type
+createGame(FrameBuffer &display, InputHandler &) {
+  static T game(display);
+  return &game;
+}
+
+// Menu order. Add an entry here to make a new game launchable.
+constexpr GameEntry GAME_REGISTRY[] = {
+  {"Space Invador", createGame<SpaceInvador>},
+  {"Flappy Bird", createGame<FlappyBird>},
+  {"Snake", createGame<SnakeGame>},
+  {"Breakout", createGame<Breakout>},
+};
+
+constexpr int GAME_COUNT = sizeof(GAME_REGISTRY) / sizeof(GAME_REGISTRY[0]);
+
+#endif
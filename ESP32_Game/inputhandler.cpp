@@ -1,13 +1,38 @@
 #include "inputhandler.h"
+#include "logger.h"
+
+InputHandler *InputHandler::_instance = nullptr;
 
 InputHandler::InputHandler(int buttonPin, int xPin, int yPin) : 
-  _buttonPin(buttonPin), _xPin(xPin), _yPin(yPin) {
+  _buttonPin(buttonPin), _xPin(xPin), _yPin(yPin), _isrLevel(false) {}
+
+void InputHandler::begin() {
   pinMode(_buttonPin, INPUT_PULLUP);
-  Serial.begin(9600);
-  Serial.println("InputHandler initialized with pins:");
-  Serial.print("Button: "); Serial.println(_buttonPin);
-  Serial.print("X Axis: "); Serial.println(_xPin);
-  Serial.print("Y Axis: "); Serial.println(_yPin);
+  _isrLevel = digitalRead(_buttonPin) == HIGH;
+  _buttonDown = _isrLevel;
+  _instance = this;
+  attachInterrupt(digitalPinToInterrupt(_buttonPin), onButtonChange, CHANGE);
+  
+  LOG_INFO(LOG_MODULE_INPUT, "InputHandler initialized with pins: Button ", _buttonPin,
+           " X Axis ", _xPin, " Y Axis ", _yPin);
+}
+
+void IRAM_ATTR InputHandler::onButtonChange() {
+  InputHandler *self = _instance;
+  uint32_t now = micros();
+  bool level = digitalRead(self->_buttonPin) == HIGH;
+  
+  // Ignore bounce after an accepted edge and repeats of the same level
+  if (now - self->_isrLastEdge < BUTTON_DEBOUNCE_US) return;
+  if (level == self->_isrLevel.load()) return;
+  
+  self->_isrLevel.store(level);
+  self->_isrLastEdge = now;
+  
+  ButtonEvent event;
+  event.type = level ? ButtonEvent::PRESS : ButtonEvent::RELEASE;
+  event.timestamp = now;
+  self->_events.push(event);
 }
 
 void InputHandler::reset() {
@@ -19,8 +44,30 @@ void InputHandler::reset() {
   right = false;
   up = false;
   down = false;
-  _lastButtonState = false;
-  _lastButtonPressTime = 0;
+  xAxis = 0;
+  _xAccumulator = -1;
+  
+  // Drop edges that arrived before the reset
+  ButtonEvent event;
+  while (_events.pop(event)) {}
+  _frameEventCount = 0;
+  _droppedSeen = _events.dropped();
+  _buttonDown = _isrLevel;
+}
+
+void InputHandler::applyEvent(const ButtonEvent &event) {
+  if (_frameEventCount < BUTTON_QUEUE_SIZE) {
+    _frameEvents[_frameEventCount++] = event;
+  }
+  
+  if (event.type == ButtonEvent::PRESS) {
+    buttonPressed = true;
+    _buttonDown = true;
+    _lastButtonPressTime = event.timestamp;
+  } else {
+    buttonReleased = true;
+    _buttonDown = false;
+  }
 }
 
 void InputHandler::update() {
@@ -34,38 +81,68 @@ void InputHandler::update() {
   xValue = analogRead(_xPin);
   yValue = analogRead(_yPin);
   
-  // Debug output
-  Serial.print("Joystick - X: "); Serial.print(xValue);
-  Serial.print(" Y: "); Serial.print(yValue);
-  Serial.print(" | Button: "); Serial.print(digitalRead(_buttonPin));
-  Serial.print(" | States: ");
-  Serial.print(left ? "LEFT " : "");
-  Serial.print(right ? "RIGHT " : "");
-  Serial.print(up ? "UP " : "");
-  Serial.print(down ? "DOWN " : "");
-  Serial.println(buttonPressed ? "PRESSED" : "");
-  
-  // Process button state
-  bool currentButtonState = digitalRead(_buttonPin) == HIGH;
-  
+  // Drain the edges queued by the ISR since the last frame, so presses
+  // shorter than a frame are still seen
   buttonPressed = false;
   buttonReleased = false;
+  _frameEventCount = 0;
+  
+  ButtonEvent event;
+  while (_events.pop(event)) {
+    applyEvent(event);
+  }
   
-  if (currentButtonState != _lastButtonState) {
-    if (currentButtonState) {
-      buttonPressed = true;
-      _lastButtonPressTime = millis();
-    } else {
-      buttonReleased = true;
+  // Edges lost to a full queue leave the drained state behind the ISR's
+  uint32_t now = micros();
+  uint32_t dropped = _events.dropped();
+  if (dropped != _droppedSeen) {
+    _droppedSeen = dropped;
+    if (_isrLevel.load() != _buttonDown) {
+      event.type = _buttonDown ? ButtonEvent::RELEASE : ButtonEvent::PRESS;
+      event.timestamp = now;
+      applyEvent(event);
     }
-    _lastButtonState = currentButtonState;
   }
   
-  buttonHeld = currentButtonState && (millis() - _lastButtonPressTime > 200);
+  // An edge swallowed by the debounce lockout leaves the ISR level stale.
+  // Once the pin has been quiet for a full window, report the real level.
+  bool level = digitalRead(_buttonPin) == HIGH;
+  bool reported = _isrLevel.load();
+  if (level != reported && now - _isrLastEdge >= BUTTON_DEBOUNCE_US &&
+      _isrLevel.compare_exchange_strong(reported, level)) {
+    event.type = level ? ButtonEvent::PRESS : ButtonEvent::RELEASE;
+    event.timestamp = now;
+    applyEvent(event);
+  }
+  
+  buttonHeld = _buttonDown && (now - _lastButtonPressTime > BUTTON_HOLD_MS * 1000UL);
   
   // Process joystick directions with deadzone
-  left = xValue < 1600;
-  right = xValue > 1700;
-  down = yValue < 1600;
-  up = yValue > 1700;
+  left = xValue < JOYSTICK_DEADZONE_LOW;
+  right = xValue > JOYSTICK_DEADZONE_HIGH;
+  down = yValue < JOYSTICK_DEADZONE_LOW;
+  up = yValue > JOYSTICK_DEADZONE_HIGH;
+  
+  // Smooth out ADC noise for analog control, then scale each side of the
+  // deadzone to the full axis range. The accumulator keeps the fraction
+  // bits a plain shift would drop, so the filter settles on the reading
+  // itself from either direction instead of stopping short of it.
+  if (_xAccumulator < 0) _xAccumulator = (int32_t)xValue << JOYSTICK_FILTER_SHIFT;
+  _xAccumulator += xValue - (_xAccumulator >> JOYSTICK_FILTER_SHIFT);
+  int xFiltered = _xAccumulator >> JOYSTICK_FILTER_SHIFT;
+  if (xFiltered < JOYSTICK_DEADZONE_LOW) {
+    xAxis = -(JOYSTICK_DEADZONE_LOW - xFiltered) * JOYSTICK_AXIS_MAX / JOYSTICK_DEADZONE_LOW;
+  } else if (xFiltered > JOYSTICK_DEADZONE_HIGH) {
+    xAxis = (xFiltered - JOYSTICK_DEADZONE_HIGH) * JOYSTICK_AXIS_MAX / (4095 - JOYSTICK_DEADZONE_HIGH);
+  } else {
+    xAxis = 0;
+  }
+  xAxis = constrain(xAxis, -JOYSTICK_AXIS_MAX, JOYSTICK_AXIS_MAX);
+  
+  // Per-frame trace, compiled out unless input debugging is enabled
+  LOG_DEBUG(LOG_MODULE_INPUT, "Joystick - X: ", xValue, " Y: ", yValue,
+            " | Button: ", _buttonDown ? 1 : 0, " | States: ",
+            left ? "LEFT " : "", right ? "RIGHT " : "",
+            up ? "UP " : "", down ? "DOWN " : "",
+            buttonPressed ? "PRESSED" : "");
 }
\ No newline at end of file
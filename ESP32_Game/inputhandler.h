@@ -2,15 +2,36 @@
 #define INPUTHANDLER_H
 
 #include <Arduino.h>
+#include <atomic>
+#include "eventqueue.h"
+
+#define BUTTON_DEBOUNCE_US 5000 // Edges closer than this to the last one are bounce
+#define BUTTON_QUEUE_SIZE 16
+#define BUTTON_HOLD_MS 200
+#define JOYSTICK_DEADZONE_LOW 1600  // Raw readings between these count as centred
+#define JOYSTICK_DEADZONE_HIGH 1700
+#define JOYSTICK_FILTER_SHIFT 2     // Each sample moves xAxis 1/4 of the way
+#define JOYSTICK_AXIS_MAX 127
+
+struct ButtonEvent {
+  enum Type : uint8_t { PRESS, RELEASE };
+  Type type;
+  uint32_t timestamp; // micros() when the edge was seen
+};
 
 class InputHandler {
 public:
   InputHandler(int buttonPin, int xPin, int yPin);
   
+  void begin();
   void update();
   void reset();
   
-  // Input states
+  // Button events drained this frame, oldest first
+  int eventCount() const { return _frameEventCount; }
+  const ButtonEvent &event(int index) const { return _frameEvents[index]; }
+  
+  // Input states (pressed/released are edges seen since the last update)
   bool buttonPressed = false;
   bool buttonReleased = false;
   bool buttonHeld = false;
@@ -18,6 +39,11 @@ public:
   int xValue = 0;
   int yValue = 0;
   
+  // Low-pass filtered X deflection, -JOYSTICK_AXIS_MAX (full left) to
+  // JOYSTICK_AXIS_MAX (full right), 0 inside the deadzone. Built from the
+  // same sample as xValue, so reading it costs no extra ADC conversion.
+  int xAxis = 0;
+  
   // Direction states (with deadzone)
   bool left = false;
   bool right = false;
@@ -25,12 +51,26 @@ public:
   bool down = false;
   
 private:
+  static void IRAM_ATTR onButtonChange();
+  void applyEvent(const ButtonEvent &event);
+  
+  static InputHandler *_instance; // Target of the button ISR
+  
   int _buttonPin;
   int _xPin;
   int _yPin;
   
-  bool _lastButtonState = false;
-  unsigned long _lastButtonPressTime = 0;
+  // Written by the ISR, read by update()
+  EventQueue<ButtonEvent, BUTTON_QUEUE_SIZE> _events;
+  std::atomic<bool> _isrLevel;
+  volatile uint32_t _isrLastEdge = 0;
+  
+  ButtonEvent _frameEvents[BUTTON_QUEUE_SIZE];
+  int _frameEventCount = 0;
+  bool _buttonDown = false;
+  uint32_t _droppedSeen = 0; // _events.dropped() at the last update()
+  uint32_t _lastButtonPressTime = 0;
+  int32_t _xAccumulator = -1; // Filtered raw X << JOYSTICK_FILTER_SHIFT, -1 until the first sample
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "linecompositor.h"
+
+LineCompositor::LineCompositor(const uint16_t *sky) :
+  sky(sky), layers(nullptr), layerCount(0), scrollX(0), stripCount(0), spriteCount(0),
+  overlay(nullptr), overlayX(0), overlayY(0), overlayColor(0) {}
+
+void LineCompositor::setLayers(const ParallaxLayer *newLayers, int count) {
+  layers = newLayers;
+  layerCount = min(count, MAX_COMPOSITOR_LAYERS);
+}
+
+void LineCompositor::addStrip(int x, int w, int top, int bottom, const uint16_t *ramp, int edge) {
+  if (stripCount == MAX_COMPOSITOR_STRIPS) return;
+  strips[stripCount++] = { (int16_t)x, (int16_t)w, (int16_t)top, (int16_t)bottom, (int16_t)edge, ramp };
+}
+
+void LineCompositor::addSprite(int x, int y, const Sprite &sprite) {
+  if (spriteCount == MAX_COMPOSITOR_SPRITES) return;
+  sprites[spriteCount++] = { (int16_t)x, (int16_t)y, &sprite };
+}
+
+void LineCompositor::setOverlay(GFXcanvas1 *canvas, int x, int y, uint16_t color) {
+  overlay = canvas;
+  overlayX = x;
+  overlayY = y;
+  overlayColor = color;
+}
+
+void LineCompositor::composeRow(int y) {
+  for (int x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+    line[x] = sky[y];
+  }
+
+  for (int l = 0; l < layerCount; l++) {
+    const ParallaxLayer &layer = layers[l];
+    int row = y - layer.top;
+    if (row < 0 || row >= layer.height) continue;
+
+    uint16_t color = layer.colors[row];
+    int wrap = layer.period - 1;
+    int offset = scrollX >> layer.speedShift;
+    for (int x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+      if (row >= layer.skyline[(x + offset) & wrap]) line[x] = color;
+    }
+  }
+
+  for (int s = 0; s < stripCount; s++) {
+    const Strip &strip = strips[s];
+    if (y < strip.top || y >= strip.bottom) continue;
+
+    uint16_t color = strip.ramp[y > strip.edge ? y - strip.edge : strip.edge - y];
+    int start = max((int)strip.x, 0);
+    int end = min(strip.x + strip.w, FRAMEBUFFER_WIDTH);
+    for (int x = start; x < end; x++) {
+      line[x] = color;
+    }
+  }
+
+  for (int s = 0; s < spriteCount; s++) {
+    const Placed &placed = sprites[s];
+    const Sprite &sprite = *placed.sprite;
+    int row = y - placed.y;
+    if (row < 0 || row >= sprite.height) continue;
+
+    const uint16_t *src = &sprite.pixels[row * sprite.width];
+    uint16_t mask = sprite.rowMasks[row];
+    while (mask) {
+      int i = __builtin_ctz(mask);
+      mask &= mask - 1;
+      int x = placed.x + i;
+      if (x >= 0 && x < FRAMEBUFFER_WIDTH) line[x] = src[i];
+    }
+  }
+
+  if (overlay) {
+    int row = y - overlayY;
+    if (row >= 0 && row < overlay->height()) {
+      const uint8_t *bits = &overlay->getBuffer()[row * ((overlay->width() + 7) / 8)];
+      for (int i = 0; i < overlay->width(); i++) {
+        int x = overlayX + i;
+        if ((bits[i >> 3] & (0x80 >> (i & 7))) && x >= 0 && x < FRAMEBUFFER_WIDTH) {
+          line[x] = overlayColor;
+        }
+      }
+    }
+  }
+}
+
+void LineCompositor::compose(FrameBuffer &fb) {
+  for (int y = 0; y < FRAMEBUFFER_HEIGHT; y++) {
+    composeRow(y);
+    fb.writeRow(y, line);
+  }
+  stripCount = 0;
+  spriteCount = 0;
+}
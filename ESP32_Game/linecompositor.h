@@ -0,0 +1,80 @@
+#ifndef LINECOMPOSITOR_H
+#define LINECOMPOSITOR_H
+
+#include <Adafruit_GFX.h>
+#include "framebuffer.h"
+#include "sprite.h"
+
+#define MAX_COMPOSITOR_LAYERS 4
+#define MAX_COMPOSITOR_STRIPS 8
+#define MAX_COMPOSITOR_SPRITES 2
+
+// A horizontally repeating background band. Column c of the pattern is
+// drawn from row top + skyline[c] down to the bottom of the band, with one
+// color per row, so hills and ground need a byte per column instead of a
+// bitmap.
+struct ParallaxLayer {
+  int16_t top, height;     // Band of rows the layer covers
+  uint8_t speedShift;      // Scrolls 1 px for every 1 << speedShift px of scroll
+  uint8_t period;          // Pattern width, a power of two
+  const uint8_t *skyline;  // period entries
+  const uint16_t *colors;  // height entries
+};
+
+// Builds a whole scene one 128-pixel scanline at a time: the sky color,
+// the parallax layers back to front, solid strips (pipes), sprites, then
+// a 1-bit overlay (the HUD). Each finished line goes through
+// FrameBuffer::writeRow, so only the runs that changed since the last
+// compose are marked dirty, as spans that are never merged with unchanged
+// sky; nothing has to be erased first and the scene itself needs a single
+// line of RAM.
+class LineCompositor {
+public:
+  // sky holds one color per screen row and must outlive the compositor
+  LineCompositor(const uint16_t *sky);
+
+  void setLayers(const ParallaxLayer *layers, int count);
+  void setScroll(int x) { scrollX = x; }
+
+  // Objects for the next compose(), which clears them again.
+  // A strip covers rows [top, bottom); row y takes ramp[|y - edge|]. Every
+  // column of a strip is the same, so one moved sideways only changes its
+  // leading and trailing columns, and each goes out as a single window.
+  void addStrip(int x, int w, int top, int bottom, const uint16_t *ramp, int edge);
+  void addSprite(int x, int y, const Sprite &sprite);
+
+  // Set bits of canvas are drawn in color at (x, y) on top of everything
+  void setOverlay(GFXcanvas1 *canvas, int x, int y, uint16_t color);
+
+  void compose(FrameBuffer &fb);
+
+private:
+  struct Strip {
+    int16_t x, w, top, bottom, edge;
+    const uint16_t *ramp;
+  };
+  struct Placed {
+    int16_t x, y;
+    const Sprite *sprite;
+  };
+
+  void composeRow(int y);
+
+  const uint16_t *sky;
+  const ParallaxLayer *layers;
+  int layerCount;
+  int scrollX;
+
+  Strip strips[MAX_COMPOSITOR_STRIPS];
+  int stripCount;
+  Placed sprites[MAX_COMPOSITOR_SPRITES];
+  int spriteCount;
+
+  GFXcanvas1 *overlay;
+  int16_t overlayX, overlayY;
+  uint16_t overlayColor;
+
+  uint16_t line[FRAMEBUFFER_WIDTH];
+};
+
+#endif
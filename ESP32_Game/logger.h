@@ -0,0 +1,59 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+
+// Log levels
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Module bits for LOG_MODULES
+#define LOG_MODULE_MAIN 0x01
+#define LOG_MODULE_INPUT 0x02
+#define LOG_MODULE_MENU 0x04
+#define LOG_MODULE_SNAKE 0x08
+#define LOG_MODULE_ALL 0xFF
+
+// Override either one before including this header (or with -D) to get
+// more output. Anything above LOG_LEVEL or outside LOG_MODULES compiles
+// away entirely, including the evaluation of its arguments.
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_WARN
+#endif
+
+#ifndef LOG_MODULES
+#define LOG_MODULES LOG_MODULE_ALL
+#endif
+
+template <uint8_t Module, uint8_t Level>
+struct Log {
+  static constexpr bool enabled = Level <= LOG_LEVEL && (Module & LOG_MODULES) != 0;
+
+  template <typename... Args>
+  static void println(const Args &... args) {
+    printAll(args...);
+    Serial.println();
+  }
+
+private:
+  static void printAll() {}
+
+  template <typename T, typename... Rest>
+  static void printAll(const T &first, const Rest &... rest) {
+    Serial.print(first);
+    printAll(rest...);
+  }
+};
+
+#define LOG_AT(module, level, ...) \
+  do { if (Log<module, level>::enabled) Log<module, level>::println(__VA_ARGS__); } while (0)
+
+#define LOG_ERROR(module, ...) LOG_AT(module, LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_WARN(module, ...) LOG_AT(module, LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_INFO(module, ...) LOG_AT(module, LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_DEBUG(module, ...) LOG_AT(module, LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+#endif
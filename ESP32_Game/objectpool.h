@@ -0,0 +1,39 @@
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <stdint.h>
+
+// Fixed-capacity pool of live objects, kept packed at the front.
+// spawn() hands out the next free slot and release() moves the last live
+// object into the freed one, so iterating live objects never skips holes
+// and nothing is allocated at runtime. When releasing while iterating,
+// don't advance past the index just released.
+template <typename T, uint8_t Capacity>
+class ObjectPool {
+public:
+  ObjectPool() : _count(0) {}
+
+  // Slot for a new object, or nullptr when the pool is full
+  T *spawn() {
+    if (_count == Capacity) return nullptr;
+    return &_items[_count++];
+  }
+
+  void release(uint8_t index) {
+    _items[index] = _items[--_count];
+  }
+
+  void clear() { _count = 0; }
+
+  uint8_t count() const { return _count; }
+  static uint8_t capacity() { return Capacity; }
+
+  T &operator[](uint8_t index) { return _items[index]; }
+  const T &operator[](uint8_t index) const { return _items[index]; }
+
+private:
+  T _items[Capacity];
+  uint8_t _count;
+};
+
+#endif
@@ -0,0 +1,123 @@
+#include "rendertask.h"
+
+#if DUAL_CORE_RENDER
+
+RenderTask::RenderTask() :
+#ifdef ESP_PLATFORM
+  backend(nullptr), handle(nullptr), busy(false), submittedAt(0),
+#else
+  backend(nullptr), woken(false), stopping(false), busy(false), submittedAt(0),
+#endif
+  submitted(0), skipped(0), latencyUs(0), maxLatencyUs(0) {
+  memset(front, 0, sizeof(front));
+  pushStats.drawCalls = 0;
+  pushStats.windowsOpened = 0;
+  pushStats.pixelsPushed = 0;
+  pushStats.stallUs = 0;
+}
+
+RenderStats RenderTask::stats() const {
+  RenderStats stats;
+  stats.submitted = submitted.load(std::memory_order_relaxed);
+  stats.skipped = skipped.load(std::memory_order_relaxed);
+  stats.latencyUs = latencyUs.load(std::memory_order_relaxed);
+  stats.maxLatencyUs = maxLatencyUs.load(std::memory_order_relaxed);
+  return stats;
+}
+
+#ifndef ESP_PLATFORM
+RenderTask::~RenderTask() {
+  if (!thread.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    stopping = true;
+  }
+  wakeSignal.notify_one();
+  thread.join();
+}
+#endif
+
+void RenderTask::begin(DisplayBackend &backend) {
+  this->backend = &backend;
+#ifdef ESP_PLATFORM
+  xTaskCreatePinnedToCore(taskEntry, "render", RENDER_TASK_STACK, this,
+                          RENDER_TASK_PRIORITY, &handle, RENDER_TASK_CORE);
+#else
+  thread = std::thread(taskEntry, this);
+#endif
+}
+
+bool RenderTask::submit(FrameBuffer &frameBuffer) {
+  const DirtyRegion &dirty = frameBuffer.dirtyRegion();
+  if (dirty.empty()) return true;
+
+  if (busy.load(std::memory_order_acquire)) {
+    skipped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Copy only the changed rows into the front buffer
+  const uint16_t *back = frameBuffer.getBuffer();
+  for (int i = 0; i < dirty.count(); i++) {
+    const DirtyRect &r = dirty.rect(i);
+    for (int16_t row = r.y; row < r.y + r.h; row++) {
+      int offset = row * FRAMEBUFFER_WIDTH + r.x;
+      memcpy(&front[offset], &back[offset], r.w * sizeof(uint16_t));
+    }
+  }
+  DirtyRect span = {0, 0, 0, 1};
+  while (dirty.nextSpan(span)) {
+    for (int16_t row = span.y; row < span.y + span.h; row++) {
+      int offset = row * FRAMEBUFFER_WIDTH + span.x;
+      memcpy(&front[offset], &back[offset], span.w * sizeof(uint16_t));
+    }
+  }
+  frontDirty = dirty;
+  frameBuffer.clearDirty();
+
+  submitted.fetch_add(1, std::memory_order_relaxed);
+  submittedAt = micros();
+  busy.store(true, std::memory_order_release);
+#ifdef ESP_PLATFORM
+  xTaskNotifyGive(handle);
+#else
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    woken = true;
+  }
+  wakeSignal.notify_one();
+#endif
+  return true;
+}
+
+void RenderTask::taskEntry(void *context) {
+  static_cast<RenderTask *>(context)->run();
+}
+
+void RenderTask::run() {
+  for (;;) {
+#ifdef ESP_PLATFORM
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#else
+    {
+      std::unique_lock<std::mutex> lock(wakeMutex);
+      wakeSignal.wait(lock, [this] { return woken || stopping; });
+      if (stopping) return;
+      woken = false;
+    }
+#endif
+    if (!busy.load(std::memory_order_acquire)) continue;
+
+    // Only this task writes the latencies, so plain load/store will do
+    uint32_t latency = micros() - submittedAt;
+    latencyUs.store(latency, std::memory_order_relaxed);
+    if (latency > maxLatencyUs.load(std::memory_order_relaxed)) {
+      maxLatencyUs.store(latency, std::memory_order_relaxed);
+    }
+
+    backend->push(front, frontDirty, pushStats);
+    busy.store(false, std::memory_order_release);
+  }
+}
+
+#endif
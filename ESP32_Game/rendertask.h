@@ -0,0 +1,103 @@
+#ifndef RENDERTASK_H
+#define RENDERTASK_H
+
+#include <Arduino.h>
+#include "framebuffer.h"
+
+#ifndef DUAL_CORE_RENDER
+#define DUAL_CORE_RENDER 0 // Set to 1 to flush from a task on the other core
+#endif
+
+#if DUAL_CORE_RENDER
+
+#include <atomic>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// The XIAO ESP32-C3 this console ships on has one core, so the feature
+// only applies to dual-core boards and to the host build
+#ifdef CONFIG_FREERTOS_UNICORE
+#error "DUAL_CORE_RENDER needs a dual-core ESP32 (this target runs FreeRTOS on one core)"
+#endif
+
+#define RENDER_TASK_CORE 0 // Arduino loop() runs on core 1
+#define RENDER_TASK_STACK 4096
+#define RENDER_TASK_PRIORITY 1
+#else
+// Host build: the task is a std::thread, woken through a condition variable
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// Snapshot of the handoff counters, see RenderTask::stats()
+struct RenderStats {
+  uint32_t submitted;    // Frames handed to the render task
+  uint32_t skipped;      // Frames kept back because the task was still pushing
+  uint32_t latencyUs;    // Last handoff: submit() until the task started pushing
+  uint32_t maxLatencyUs;
+};
+
+// Flushes the FrameBuffer from a FreeRTOS task pinned to the other core
+// (a thread on the host).
+// submit() copies the dirty pixels into a private front buffer and
+// wakes the task, which pushes them over SPI while loop() goes on
+// simulating. The handoff is a single atomic flag: the front buffer
+// belongs to the task while it is set and to the caller otherwise. When
+// the task is still busy submit() leaves the canvas dirty, so the changes
+// go out merged with the next frame.
+class RenderTask {
+public:
+  RenderTask();
+#ifndef ESP_PLATFORM
+  ~RenderTask();
+#endif
+
+  // Start the task pushing to backend; it must be set up already
+  void begin(DisplayBackend &backend);
+
+  // Hand over this frame's changes; false if the task was busy
+  bool submit(FrameBuffer &frameBuffer);
+
+  // True once the task has pushed everything submitted so far
+  bool idle() const { return !busy.load(std::memory_order_acquire); }
+
+  // Safe to call at any time; each counter is read atomically
+  RenderStats stats() const;
+
+  // Written by the task while it pushes; only read it once idle()
+  const FlushStats &flushStats() const { return pushStats; }
+
+private:
+  static void taskEntry(void *context);
+  void run();
+
+  DisplayBackend *backend;
+#ifdef ESP_PLATFORM
+  TaskHandle_t handle;
+#else
+  std::thread thread;
+  std::mutex wakeMutex;
+  std::condition_variable wakeSignal;
+  bool woken;    // Guarded by wakeMutex, like a pending task notification
+  bool stopping; // Guarded by wakeMutex
+#endif
+  std::atomic<bool> busy;
+
+  // Owned by the task while busy is set
+  uint16_t front[FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT];
+  DirtyRegion frontDirty;
+  uint32_t submittedAt;
+  FlushStats pushStats;
+
+  // submit() counts frames on the caller's side, the task times the
+  // handoffs on its own; both are read from the caller's side
+  std::atomic<uint32_t> submitted, skipped;
+  std::atomic<uint32_t> latencyUs, maxLatencyUs;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+#include "scheduler.h"
+
+Scheduler scheduler;
+
+Scheduler::Scheduler() {
+  for (int i = 0; i < MAX_SCHEDULED_TASKS; i++) {
+    tasks[i].active = false;
+    tasks[i].generation = 0;
+  }
+}
+
+int Scheduler::after(unsigned long delayMs, TaskCallback callback, void *context) {
+  return schedule(delayMs, 0, callback, context);
+}
+
+int Scheduler::every(unsigned long periodMs, TaskCallback callback, void *context) {
+  return schedule(periodMs, periodMs, callback, context);
+}
+
+int Scheduler::schedule(unsigned long delayMs, unsigned long periodMs, TaskCallback callback, void *context) {
+  for (int i = 0; i < MAX_SCHEDULED_TASKS; i++) {
+    if (!tasks[i].active) {
+      Task &task = tasks[i];
+      task.callback = callback;
+      task.context = context;
+      task.due = millis() + delayMs;
+      task.period = periodMs;
+      task.generation++;
+      task.active = true;
+      return task.generation * MAX_SCHEDULED_TASKS + i;
+    }
+  }
+  return -1;
+}
+
+int Scheduler::slotOf(int id) const {
+  if (id < 0) return -1;
+
+  int slot = id % MAX_SCHEDULED_TASKS;
+  uint8_t generation = id / MAX_SCHEDULED_TASKS;
+  if (!tasks[slot].active || tasks[slot].generation != generation) return -1;
+  return slot;
+}
+
+void Scheduler::cancel(int id) {
+  int slot = slotOf(id);
+  if (slot >= 0) {
+    tasks[slot].active = false;
+  }
+}
+
+bool Scheduler::isPending(int id) const {
+  return slotOf(id) >= 0;
+}
+
+void Scheduler::run() {
+  unsigned long now = millis();
+
+  for (int i = 0; i < MAX_SCHEDULED_TASKS; i++) {
+    Task &task = tasks[i];
+    if (!task.active || (long)(now - task.due) < 0) continue;
+
+    if (task.period > 0) {
+      task.due += task.period;
+      // Don't replay missed periods after a long stall
+      if ((long)(now - task.due) >= 0) task.due = now + task.period;
+    } else {
+      task.active = false;
+    }
+
+    // May schedule or cancel tasks, including this one
+    task.callback(task.context);
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#define MAX_SCHEDULED_TASKS 8
+
+typedef void (*TaskCallback)(void *context);
+
+// Cooperative millis()-based timer queue.
+// run() is called once per loop() and fires every task that has come due,
+// so timed effects never block the main loop.
+class Scheduler {
+public:
+  Scheduler();
+
+  // Both return a task id for cancel(), or -1 when all slots are taken
+  int after(unsigned long delayMs, TaskCallback callback, void *context);
+  int every(unsigned long periodMs, TaskCallback callback, void *context);
+
+  void cancel(int id);
+  bool isPending(int id) const;
+  void run();
+
+private:
+  struct Task {
+    TaskCallback callback;
+    void *context;
+    unsigned long due;
+    unsigned long period; // 0 for one-shot tasks
+    uint8_t generation;   // Invalidates ids of finished tasks
+    bool active;
+  };
+
+  int schedule(unsigned long delayMs, unsigned long periodMs, TaskCallback callback, void *context);
+  int slotOf(int id) const;
+
+  Task tasks[MAX_SCHEDULED_TASKS];
+};
+
+extern Scheduler scheduler;
+
+#endif
@@ -2,19 +2,37 @@
 #define SNAKE_H
 
 #include <Arduino.h>
+#include <type_traits>
+#include "bitboard.h"
 #include "inputhandler.h"
 
+#ifndef SNAKE_GRID_SIZE
+#define SNAKE_GRID_SIZE 12 // Arena cells per side; arenas larger than the screen scroll
+#endif
+#define SNAKE_MAX_SEGMENTS 1024 // Body length cap for arenas too big to fill
+#define SNAKE_FOOD_TRIES 4 // Random probes before food placement scans the board
+
 struct Point {
   int x, y;
 };
 
-class Snake {
+// Snake on a GridSize x GridSize wrapping arena (at most 256 x 256).
+// Everything done per tick is O(1) in the arena size; only reset() and
+// food placement on a crowded board touch the whole occupancy map.
+template <int GridSize>
+class BasicSnake {
 public:
-  static const int GRID_SIZE = 12; // Adjusted for better fit on 128x128 display
-  static const int MAX_LENGTH = 64;
+  static const int GRID_SIZE = GridSize;
+  static const int CELL_COUNT = GRID_SIZE * GRID_SIZE;
+  // Small arenas can be filled completely
+  static const int MAX_LENGTH = CELL_COUNT < SNAKE_MAX_SEGMENTS ? CELL_COUNT : SNAKE_MAX_SEGMENTS;
   static const int INITIAL_LENGTH = 3;
   
-  Snake(InputHandler* input) : _input(input) {}
+  // Body segments are stored as packed cell indices, a byte each while
+  // the grid has at most 256 cells
+  typedef typename std::conditional<(CELL_COUNT <= 256), uint8_t, uint16_t>::type Cell;
+  
+  BasicSnake(InputHandler* input) : _input(input) {}
   
   void reset() {
     // Initialize snake position (start in middle)
@@ -22,67 +40,77 @@ public:
     int startX = GRID_SIZE / 2;
     int startY = GRID_SIZE / 2;
     
-    // Initialize snake body segments
+    // Initialize snake body segments, tail first so the head ends up
+    // in the newest slot
+    _occupied.reset();
+    _head = _length - 1;
     for (int i = 0; i < _length; i++) {
-      _positions[i].x = startX - i;
-      _positions[i].y = startY;
+      Point p = { startX - i, startY };
+      _body[_head - i] = cellOf(p);
+      _occupied.set(cellOf(p));
     }
+    _vacated = {-1, -1};
     
     _direction.x = 1;
     _direction.y = 0;
+    _nextDirection = _direction;
     _score = 0;
     _gameOver = false;
     spawnFood();
   }
   
-  void update() {
-    if (_gameOver) return;
-    
-    // Update direction based on input
+  // Sample the joystick every frame so a turn made between ticks
+  // is applied on the next one
+  void steer() {
     if (_input->left && _direction.x != 1) {
-      _direction = {-1, 0};
+      _nextDirection = {-1, 0};
     } else if (_input->right && _direction.x != -1) {
-      _direction = {1, 0};
+      _nextDirection = {1, 0};
     } else if (_input->up && _direction.y != 1) {
-      _direction = {0, -1};
+      _nextDirection = {0, -1};
     } else if (_input->down && _direction.y != -1) {
-      _direction = {0, 1};
+      _nextDirection = {0, 1};
     }
+  }
+  
+  void update() {
+    if (_gameOver) return;
+    
+    // Apply the last direction chosen since the previous tick
+    steer();
+    _direction = _nextDirection;
     
     // Move snake
+    Point head = getPosition(0);
     Point newHead = {
-      (_positions[0].x + _direction.x + GRID_SIZE) % GRID_SIZE,
-      (_positions[0].y + _direction.y + GRID_SIZE) % GRID_SIZE
+      (head.x + _direction.x + GRID_SIZE) % GRID_SIZE,
+      (head.y + _direction.y + GRID_SIZE) % GRID_SIZE
     };
     
-    // Check collision with self (skip head)
-    for (int i = 1; i < _length; i++) {
-      if (newHead.x == _positions[i].x && newHead.y == _positions[i].y) {
-        _gameOver = true;
-        return;
-      }
+    // Check collision with self; the head can't be on newHead
+    if (_occupied.test(cellOf(newHead))) {
+      _gameOver = true;
+      return;
     }
     
     // Check food collision first
     bool ateFood = (newHead.x == _food.x && newHead.y == _food.y);
     
-    // Move body
-    if (ateFood) {
-      // When eating, shift all segments right and add new head
-      for (int i = _length; i > 0; i--) {
-        _positions[i] = _positions[i - 1];
-      }
-      _positions[0] = newHead;
+    // Move body: the head goes in the next slot of the ring and, unless
+    // the snake grows, the tail is dropped from the other end
+    bool grow = ateFood && _length < MAX_LENGTH;
+    if (ateFood) _score += 10;
+    if (grow) {
+      _vacated = {-1, -1};
       _length++;
-      _score += 10;
-      spawnFood();
     } else {
-      // Normal movement - shift all segments except head
-      for (int i = _length - 1; i > 0; i--) {
-        _positions[i] = _positions[i - 1];
-      }
-      _positions[0] = newHead;
+      _vacated = getPosition(_length - 1);
+      _occupied.clear(cellOf(_vacated));
     }
+    _head = (_head + 1) % MAX_LENGTH;
+    _body[_head] = cellOf(newHead);
+    _occupied.set(cellOf(newHead));
+    if (ateFood) spawnFood();
   }
   
   void render() {
@@ -92,17 +120,9 @@ public:
     // Draw border and game area
     for (int y = 0; y < GRID_SIZE; y++) {
       for (int x = 0; x < GRID_SIZE; x++) {
-        bool isSnake = false;
-        for (int i = 0; i < _length; i++) {
-          if (_positions[i].x == x && _positions[i].y == y) {
-            isSnake = true;
-            break;
-          }
-        }
-        
         if (x == _food.x && y == _food.y) {
           Serial.print("O");
-        } else if (isSnake) {
+        } else if (isOccupied(x, y)) {
           Serial.print("#");
         } else {
           Serial.print(".");
@@ -125,34 +145,50 @@ public:
   // Getter methods for rendering
   const Point& getFood() const { return _food; }
   int getLength() const { return _length; }
-  const Point& getPosition(int index) const { return _positions[index]; }
+  // Segment index counted from the head
+  Point getPosition(int index) const {
+    int cell = _body[(_head + MAX_LENGTH - index) % MAX_LENGTH];
+    return { cell % GRID_SIZE, cell / GRID_SIZE };
+  }
+  // Cell the tail left on the last move, or x == -1 if the snake grew
+  const Point& getVacated() const { return _vacated; }
+  bool isOccupied(int x, int y) const { return _occupied.test(y * GRID_SIZE + x); }
   
 private:
+  static int cellOf(const Point &p) { return p.y * GRID_SIZE + p.x; }
   
+  // Pick uniformly among the free cells; a full board ends the game and
+  // leaves no food (x == -1). While the board is mostly empty a few random
+  // probes find a cell without scanning it; either way is uniform.
   void spawnFood() {
-    do {
-      _food.x = random(GRID_SIZE);
-      _food.y = random(GRID_SIZE);
-      
-      bool onSnake = false;
-      for (int i = 0; i < _length; i++) {
-        if (_food.x == _positions[i].x && _food.y == _positions[i].y) {
-          onSnake = true;
-          break;
-        }
-      }
-      
-      if (!onSnake) break;
-    } while (true);
+    int cell = -1;
+    for (int i = 0; i < SNAKE_FOOD_TRIES && cell < 0; i++) {
+      int probe = random(CELL_COUNT);
+      if (!_occupied.test(probe)) cell = probe;
+    }
+    if (cell < 0) cell = _occupied.selectFree(random(max(_occupied.freeCount(), 1)));
+    if (cell < 0) {
+      _food = {-1, -1};
+      _gameOver = true;
+      return;
+    }
+    _food.x = cell % GRID_SIZE;
+    _food.y = cell / GRID_SIZE;
   }
   
   InputHandler* _input;
-  Point _positions[MAX_LENGTH];
+  Cell _body[MAX_LENGTH]; // Ring of segments, _head is the newest
+  int _head;
+  Point _vacated;
   Point _direction;
+  Point _nextDirection;
   Point _food;
+  Bitboard<CELL_COUNT> _occupied; // Cells covered by the body
   int _length;
   int _score;
   bool _gameOver;
 };
 
+typedef BasicSnake<SNAKE_GRID_SIZE> Snake;
+
 #endif
\ No newline at end of file
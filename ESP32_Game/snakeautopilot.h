@@ -0,0 +1,192 @@
+#ifndef SNAKEAUTOPILOT_H
+#define SNAKEAUTOPILOT_H
+
+#include <Arduino.h>
+#include "bitboard.h"
+#include "inputhandler.h"
+#include "snake.h"
+
+#ifndef SNAKE_AUTOPILOT
+#define SNAKE_AUTOPILOT 0 // Set to 1 to let SnakeGame play itself for soak tests
+#endif
+#define SNAKE_AI_SEARCH_CELLS 1024 // Cells a path search may visit before giving up
+
+struct AutopilotStats {
+  uint32_t ticks;   // Moves chosen
+  uint32_t plans;   // Path searches run
+  uint32_t planUs;  // Time spent choosing moves
+  uint32_t games;
+  int bestLength;
+};
+
+// Plays a BasicSnake by pressing directions on an InputHandler, so the
+// game can't tell it from a player. A breadth-first search over the
+// occupancy map finds the shortest path to the food; the path is cached
+// and followed until the food moves or its next cell turns out blocked,
+// so most ticks cost a single bit test. A search that gives up after
+// SNAKE_AI_SEARCH_CELLS leads to the visited cell nearest the food, and
+// the next one starts from there. With no free path at all the snake
+// follows a Hamiltonian cycle (even grids) or any free neighbour.
+template <int GridSize>
+class SnakeAutopilot {
+public:
+  typedef BasicSnake<GridSize> SnakeType;
+  static const int SEARCH_CELLS = SnakeType::CELL_COUNT < SNAKE_AI_SEARCH_CELLS ?
+                                  SnakeType::CELL_COUNT : SNAKE_AI_SEARCH_CELLS;
+
+  SnakeAutopilot(const SnakeType &snake) : snake(snake) {
+    memset(&_stats, 0, sizeof(_stats));
+    reset();
+  }
+
+  // Forget the cached path, e.g. after snake.reset()
+  void reset() {
+    pathLength = pathPos = 0;
+    plannedFood = -1;
+  }
+
+  // Call right before snake.update(); presses the direction of the next move
+  void steer(InputHandler &input) {
+    unsigned long start = micros();
+    Point head = snake.getPosition(0);
+    int next = chooseMove(cellOf(head));
+    _stats.planUs += micros() - start;
+    _stats.ticks++;
+
+    input.left = input.right = input.up = input.down = false;
+    if (next < 0) return; // Boxed in; keep going
+    int dx = (next % GridSize - head.x + GridSize) % GridSize;
+    int dy = (next / GridSize - head.y + GridSize) % GridSize;
+    input.right = dx == 1;
+    input.left = dx == GridSize - 1;
+    input.down = dy == 1;
+    input.up = dy == GridSize - 1;
+  }
+
+  // Record a finished game in the stats
+  void gameOver() {
+    _stats.games++;
+    _stats.bestLength = max(_stats.bestLength, snake.getLength());
+    reset();
+  }
+
+  const AutopilotStats &stats() const { return _stats; }
+
+private:
+  struct Visit {
+    uint16_t cell;
+    uint16_t parent; // Index of the visit it was reached from
+  };
+
+  static int cellOf(const Point &p) { return p.y * GridSize + p.x; }
+
+  static int neighbour(int cell, int dir) {
+    int x = cell % GridSize, y = cell / GridSize;
+    switch (dir) {
+      case 0: x = (x + 1) % GridSize; break;
+      case 1: y = (y + 1) % GridSize; break;
+      case 2: x = (x + GridSize - 1) % GridSize; break;
+      default: y = (y + GridSize - 1) % GridSize; break;
+    }
+    return y * GridSize + x;
+  }
+
+  // Successor on a cycle through every cell of an even grid: rows are swept
+  // as a serpentine over columns 1.., and column 0 leads back to the top
+  static int cycleNext(int cell) {
+    if (GridSize % 2) return -1;
+    int x = cell % GridSize, y = cell / GridSize;
+    if (x == 0) return y == 0 ? 1 : cell - GridSize;
+    if (y % 2 == 0) return x == GridSize - 1 ? cell + GridSize : cell + 1;
+    if (x > 1) return cell - 1;
+    return y == GridSize - 1 ? cell - 1 : cell + GridSize;
+  }
+
+  // Steps between two cells on the wrapping grid
+  static int distance(int a, int b) {
+    int dx = abs(a % GridSize - b % GridSize), dy = abs(a / GridSize - b / GridSize);
+    return min(dx, GridSize - dx) + min(dy, GridSize - dy);
+  }
+
+  bool isFree(int cell) const { return !snake.isOccupied(cell % GridSize, cell / GridSize); }
+
+  int chooseMove(int head) {
+    const Point &food = snake.getFood();
+    int foodCell = food.x >= 0 ? cellOf(food) : -1;
+    if (foodCell != plannedFood) {
+      pathLength = pathPos = 0;
+      plannedFood = foodCell;
+    }
+
+    if (pathPos < pathLength && isFree(path[pathPos])) return path[pathPos++];
+    if (foodCell >= 0 && plan(head, foodCell)) return path[pathPos++];
+
+    // Nowhere to go that gets closer: circle, else survive
+    int next = cycleNext(head);
+    if (next >= 0 && isFree(next)) return next;
+    for (int dir = 0; dir < 4; dir++) {
+      if (isFree(neighbour(head, dir))) return neighbour(head, dir);
+    }
+    return -1;
+  }
+
+  // Breadth-first search from head to goal. Fills path with the way to the
+  // goal, or to the visited cell nearest it when the search is cut short;
+  // false if the head can't move at all.
+  bool plan(int head, int goal) {
+    _stats.plans++;
+    pathLength = pathPos = 0;
+
+    int count = 0, found = -1;
+    int nearest = 0, nearestDistance = distance(head, goal);
+    queue[count++] = { (uint16_t)head, 0 };
+    visited.set(head);
+    for (int i = 0; i < count && found < 0; i++) {
+      for (int dir = 0; dir < 4; dir++) {
+        int next = neighbour(queue[i].cell, dir);
+        if (visited.test(next) || !isFree(next)) continue;
+        if (count == SEARCH_CELLS) break;
+        visited.set(next);
+        queue[count++] = { (uint16_t)next, (uint16_t)i };
+        if (next == goal) {
+          found = count - 1;
+          break;
+        }
+        int d = distance(next, goal);
+        if (d < nearestDistance) {
+          nearest = count - 1;
+          nearestDistance = d;
+        }
+      }
+    }
+
+    // Only clear what the search marked, so a search stays independent
+    // of the arena size
+    for (int i = 0; i < count; i++) {
+      visited.clear(queue[i].cell);
+    }
+    if (found < 0) found = nearest;
+    if (found == 0) return false;
+
+    for (int i = found; i != 0; i = queue[i].parent) {
+      pathLength++;
+    }
+    int slot = pathLength;
+    for (int i = found; i != 0; i = queue[i].parent) {
+      path[--slot] = queue[i].cell;
+    }
+    return true;
+  }
+
+  const SnakeType &snake;
+  AutopilotStats _stats;
+
+  uint16_t path[SEARCH_CELLS]; // Cells to enter, next move first
+  int pathLength, pathPos;
+  int plannedFood; // Food cell the path leads to
+
+  Visit queue[SEARCH_CELLS];
+  Bitboard<SnakeType::CELL_COUNT> visited;
+};
+
+#endif
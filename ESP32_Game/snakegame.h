@@ -3,11 +3,21 @@
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7735.h>
+#include "framebuffer.h"
+#include "game.h"
 #include <EEPROM.h>
+#include "logger.h"
 #include "snake.h"
+#include "snakeautopilot.h"
 #include "inputhandler.h"
 
-class SnakeGame {
+#define SNAKE_TICK_MS 150 // Game speed control
+#define SNAKE_MIN_CELL_PX 8 // Smallest cell before the arena scrolls instead
+#define SNAKE_CAMERA_MARGIN 3 // Cells kept between the head and a scrolling edge
+
+// Snake on a GridSize x GridSize arena; SnakeGame is the console's size
+template <int GridSize>
+class BasicSnakeGame : public Game {
 public:
   enum GameState {
     INTRO,
@@ -15,48 +25,85 @@ public:
     GAME_OVER
   };
 
-  SnakeGame(Adafruit_ST7735* display, InputHandler* input)
-    : tft(display), input_handler(input), snake(input), currentState(INTRO), highScore(0) {
+  BasicSnakeGame(FrameBuffer &display, InputHandler &input)
+    : tft(&display), snake(&input),
+#if SNAKE_AUTOPILOT
+      autopilot(snake),
+#endif
+      currentState(INTRO), menuRequested(false), highScore(0),
+      tickTimer(0), needsRender(false) {
     // Calculate cell dimensions to fit screen while maintaining aspect ratio
-    int maxCellWidth = (tft->width() - 4) / Snake::GRID_SIZE; // Leave 2px margin on each side
-    int maxCellHeight = (tft->height() - 24) / Snake::GRID_SIZE; // Leave more space for score at bottom
-    cellWidth = min(maxCellWidth, maxCellHeight);
+    int areaWidth = tft->width() - 4; // Leave 2px margin on each side
+    int areaHeight = tft->height() - 24; // Leave more space for score at bottom
+    int gridSize = GridSize;
+    cellWidth = max(min(areaWidth / gridSize, areaHeight / gridSize), SNAKE_MIN_CELL_PX);
     cellHeight = cellWidth; // Keep cells square
     
+    // An arena that doesn't fit is seen through a viewport following the head
+    viewCols = min(gridSize, areaWidth / cellWidth);
+    viewRows = min(gridSize, areaHeight / cellHeight);
+    cameraX = cameraY = 0;
+    
     // Calculate offset to center the game grid
-    offsetX = (tft->width() - (Snake::GRID_SIZE * cellWidth)) / 2;
+    offsetX = (tft->width() - (viewCols * cellWidth)) / 2;
     offsetY = 4; // Increase top margin slightly
-    
-    memset(lastGrid, 0, sizeof(lastGrid));
   }
 
-  void init() {
+  void init() override {
     EEPROM.begin(4); // Initialize EEPROM with 4 bytes for high score
     highScore = EEPROM.read(0) | (EEPROM.read(1) << 8); // Read high score from EEPROM
     currentState = INTRO;
+    menuRequested = false;
     snake.reset();
     tft->fillScreen(ST77XX_BLACK);
     drawIntroScreen();
   }
 
-  void update() {
+  void update(unsigned long dt, InputHandler &input) override {
+#if SNAKE_AUTOPILOT
+    // Nobody is at the controls: tap through every screen right away
+    if (currentState != PLAYING) {
+      input.buttonPressed = true;
+      input.buttonReleased = true;
+    }
+#endif
     switch (currentState) {
       case INTRO:
-        if (input_handler->buttonPressed) {
+        if (input.buttonPressed) {
           currentState = PLAYING;
           snake.reset();
           tft->fillScreen(ST77XX_BLACK);
           drawBorder();
-          input_handler->buttonPressed = false;
+          drawBoard();
+          input.buttonPressed = false;
+          tickTimer = 0;
         }
         break;
 
       case PLAYING:
+        snake.steer();
+        tickTimer += dt;
+        if (tickTimer < SNAKE_TICK_MS) break;
+        tickTimer -= SNAKE_TICK_MS;
+        
+        // Each tick only reports its own head and tail, so draw a tick
+        // that render() hasn't picked up yet before making the next
+        if (needsRender) drawChanges();
+#if SNAKE_AUTOPILOT
+        autopilot.steer(input);
+#endif
         snake.update();
-        render();
+        needsRender = true;
         if (snake.isGameOver()) {
           currentState = GAME_OVER;
+          needsRender = false;
           int currentScore = snake.getScore();
+#if SNAKE_AUTOPILOT
+          // Report instead of wearing out the EEPROM with a soak test's scores
+          autopilot.gameOver();
+          reportAutopilot();
+          currentScore = 0;
+#endif
           if (currentScore > highScore) {
             highScore = currentScore;
             // Save new high score to EEPROM
@@ -64,29 +111,42 @@ public:
             EEPROM.write(1, (highScore >> 8) & 0xFF);
             EEPROM.commit();
           }
+          gameOverInput.reset();
           drawGameOverScreen();
         }
-        delay(150); // Game speed control
         break;
 
       case GAME_OVER:
-        if (input_handler->buttonPressed) {
-          currentState = INTRO;
-          tft->fillScreen(ST77XX_BLACK);
-          drawIntroScreen();
-          input_handler->buttonPressed = false;
+        switch (gameOverInput.update(input)) {
+          case GameOverInput::RESTART:
+            currentState = INTRO;
+            tft->fillScreen(ST77XX_BLACK);
+            drawIntroScreen();
+            input.buttonPressed = false;
+            break;
+          case GameOverInput::MENU:
+            menuRequested = true;
+            break;
+          case GameOverInput::NONE:
+            break;
         }
         break;
     }
   }
 
-  bool isGameOver() const {
-    return currentState == GAME_OVER;
+  // Draw the cells changed by the last tick
+  void render(Fixed8) override {
+    if (!needsRender) return;
+    drawChanges();
+    needsRender = false;
+  }
+
+  bool wantsMenu() const override {
+    return menuRequested;
   }
 
 private:
-  GameState currentState;
-  int highScore;
+  enum CellContent { EMPTY, BODY, FOOD };
 
   void drawIntroScreen() {
     // Clear screen first
@@ -170,55 +230,135 @@ private:
     tft->setTextSize(1);
     if((millis() / 500) % 2) {
       tft->setTextColor(ST77XX_WHITE);
-      tft->setCursor(15, 110);
+      tft->setCursor(15, 104);
       tft->print("PRESS TO RESTART!");
     }
+    tft->setTextColor(ST77XX_CYAN);
+    tft->setCursor(25, 116);
+    tft->print("HOLD FOR MENU");
   }
 
-private:
-  void render() {
-    // Create current grid state
-    uint8_t currentGrid[Snake::GRID_SIZE][Snake::GRID_SIZE] = {0};
+  // Viewport column/row of an arena cell, or -1 when it's off screen
+  int viewColumn(int x) const {
+    int column = (x - cameraX + GridSize) % GridSize;
+    return column < viewCols ? column : -1;
+  }
+  int viewRow(int y) const {
+    int row = (y - cameraY + GridSize) % GridSize;
+    return row < viewRows ? row : -1;
+  }
+
+  CellContent contentAt(int x, int y) const {
+    const Point &food = snake.getFood();
+    if (x == food.x && y == food.y) return FOOD;
+    return snake.isOccupied(x, y) ? BODY : EMPTY;
+  }
+
+  // Draw an arena cell if it's inside the viewport
+  void drawCell(const Point &cell, CellContent content) {
+    int column = viewColumn(cell.x), row = viewRow(cell.y);
+    if (column < 0 || row < 0) return;
     
-    // Mark snake positions
-    for (int i = 0; i < snake.getLength(); i++) {
-      const Point& pos = snake.getPosition(i);
-      currentGrid[pos.y][pos.x] = 1;
+    int screenX = offsetX + (column * cellWidth);
+    int screenY = offsetY + (row * cellHeight);
+    
+    // Clear cell
+    tft->fillRect(screenX, screenY, cellWidth, cellHeight, ST77XX_BLACK);
+    
+    if (content == BODY) {
+      // Draw snake segment with rounded corners
+      tft->fillRoundRect(screenX + 1, screenY + 1,
+                      cellWidth - 2, cellHeight - 2,
+                      2, ST77XX_GREEN);
+    } else if (content == FOOD) {
+      // Draw food as a small circle
+      int foodSize = min(cellWidth, cellHeight) - 4;
+      int foodX = screenX + (cellWidth - foodSize) / 2;
+      int foodY = screenY + (cellHeight - foodSize) / 2;
+      tft->fillCircle(foodX + foodSize/2, foodY + foodSize/2,
+                   foodSize/2, ST77XX_RED);
+    }
+  }
+
+  // Draw every visible cell on a cleared board, with the head centered
+  // when the arena scrolls
+  void drawBoard() {
+    Point head = snake.getPosition(0);
+    if (viewCols < GridSize) {
+      cameraX = (head.x - viewCols / 2 + GridSize) % GridSize;
+    }
+    if (viewRows < GridSize) {
+      cameraY = (head.y - viewRows / 2 + GridSize) % GridSize;
     }
     
-    // Mark food position
-    const Point& food = snake.getFood();
-    currentGrid[food.y][food.x] = 2;
+    for (int row = 0; row < viewRows; row++) {
+      for (int column = 0; column < viewCols; column++) {
+        Point cell = { (cameraX + column) % GridSize, (cameraY + row) % GridSize };
+        CellContent content = contentAt(cell.x, cell.y);
+        if (content != EMPTY) drawCell(cell, content);
+      }
+    }
+    drawnFood = snake.getFood();
+    lastScore = -1;
+    drawChanges();
+  }
+
+  // Scroll the viewport by one cell along an axis and draw the exposed
+  // column (dx) or row (dy) from the arena state
+  void scrollView(int dx, int dy) {
+    int gridSize = GridSize;
+    cameraX = (cameraX + dx + gridSize) % gridSize;
+    cameraY = (cameraY + dy + gridSize) % gridSize;
+    tft->scrollRect(offsetX, offsetY, viewCols * cellWidth, viewRows * cellHeight,
+                    -dx * cellWidth, -dy * cellHeight);
     
-    // Only update changed cells
-    for (int y = 0; y < Snake::GRID_SIZE; y++) {
-      for (int x = 0; x < Snake::GRID_SIZE; x++) {
-        if (currentGrid[y][x] != lastGrid[y][x]) {
-          int screenX = offsetX + (x * cellWidth);
-          int screenY = offsetY + (y * cellHeight);
-          
-          // Clear cell
-          tft->fillRect(screenX, screenY, cellWidth, cellHeight, ST77XX_BLACK);
-          
-          // Draw new content if any
-          if (currentGrid[y][x] == 1) {
-            // Draw snake segment with rounded corners
-            tft->fillRoundRect(screenX + 1, screenY + 1,
-                            cellWidth - 2, cellHeight - 2,
-                            2, ST77XX_GREEN);
-          } else if (currentGrid[y][x] == 2) {
-            // Draw food as a small circle
-            int foodSize = min(cellWidth, cellHeight) - 4;
-            int foodX = screenX + (cellWidth - foodSize) / 2;
-            int foodY = screenY + (cellHeight - foodSize) / 2;
-            tft->fillCircle(foodX + foodSize/2, foodY + foodSize/2,
-                         foodSize/2, ST77XX_RED);
-          }
-          
-          lastGrid[y][x] = currentGrid[y][x];
-        }
+    int count = dx ? viewRows : viewCols;
+    for (int i = 0; i < count; i++) {
+      Point cell;
+      if (dx) {
+        cell.x = (cameraX + (dx > 0 ? viewCols - 1 : 0)) % gridSize;
+        cell.y = (cameraY + i) % gridSize;
+      } else {
+        cell.x = (cameraX + i) % gridSize;
+        cell.y = (cameraY + (dy > 0 ? viewRows - 1 : 0)) % gridSize;
       }
+      drawCell(cell, contentAt(cell.x, cell.y));
     }
+  }
+
+  // Keep the head SNAKE_CAMERA_MARGIN cells inside a scrolling viewport;
+  // it moves a cell per tick, so the camera never has to move further
+  void followHead() {
+    Point head = snake.getPosition(0);
+    int gridSize = GridSize;
+    if (viewCols < gridSize) {
+      int column = (head.x - cameraX + gridSize) % gridSize;
+      if (column >= viewCols - SNAKE_CAMERA_MARGIN && column < viewCols) scrollView(1, 0);
+      else if (column < SNAKE_CAMERA_MARGIN) scrollView(-1, 0);
+    }
+    if (viewRows < gridSize) {
+      int row = (head.y - cameraY + gridSize) % gridSize;
+      if (row >= viewRows - SNAKE_CAMERA_MARGIN && row < viewRows) scrollView(0, 1);
+      else if (row < SNAKE_CAMERA_MARGIN) scrollView(0, -1);
+    }
+  }
+
+  // A move only changes the new head, the cell the tail left and, after
+  // eating, the food; everything else on the board is already right.
+  // Scrolling adds one exposed row or column of cells.
+  void drawChanges() {
+    followHead();
+    
+    const Point &vacated = snake.getVacated();
+    if (vacated.x >= 0) drawCell(vacated, EMPTY);
+    drawCell(snake.getPosition(0), BODY);
+    
+    // There is no food once the board is full
+    const Point &food = snake.getFood();
+    if (food.x >= 0 && (food.x != drawnFood.x || food.y != drawnFood.y)) {
+      drawCell(food, FOOD);
+    }
+    drawnFood = food;
 
     // Clear and draw score
     // Only update score display if it changed
@@ -241,19 +381,39 @@ private:
     }
   }
 
+#if SNAKE_AUTOPILOT
+  void reportAutopilot() {
+    const AutopilotStats &stats = autopilot.stats();
+    LOG_INFO(LOG_MODULE_SNAKE, "Autopilot: games ", stats.games, " best ", stats.bestLength,
+             " ticks ", stats.ticks, " plans ", stats.plans, " planUs ", stats.planUs);
+  }
+#endif
+
   void drawBorder() {
     tft->drawRect(0, 0, tft->width(), tft->height(), ST77XX_WHITE);
   }
 
-  Adafruit_ST7735* tft;
-  InputHandler* input_handler;
-  Snake snake;
+  FrameBuffer* tft;
+  BasicSnake<GridSize> snake;
+#if SNAKE_AUTOPILOT
+  SnakeAutopilot<GridSize> autopilot;
+#endif
+  GameState currentState;
+  GameOverInput gameOverInput;
+  bool menuRequested;
+  int highScore;
+  unsigned long tickTimer; // Simulation time since the last snake move
+  bool needsRender;
   int cellWidth;
   int cellHeight;
   int offsetX;
   int offsetY;
-  uint8_t lastGrid[Snake::GRID_SIZE][Snake::GRID_SIZE];
+  int viewCols, viewRows; // Cells on screen
+  int cameraX, cameraY;   // Arena cell shown at the top left
+  Point drawnFood; // Food cell on screen
   int lastScore = -1;  // Track last score to avoid unnecessary updates
 };
 
+typedef BasicSnakeGame<SNAKE_GRID_SIZE> SnakeGame;
+
 #endif
\ No newline at end of file
@@ -3,6 +3,14 @@
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7735.h>
+#include "config.h"
+#include "formationrenderer.h"
+#include "framebuffer.h"
+#include "game.h"
+#include "inputhandler.h"
+#include "objectpool.h"
+#include "sprite.h"
+#include "vibration.h"
 #include <SPI.h>
 #include <EEPROM.h>
 
@@ -11,21 +19,30 @@
 #define SCREEN_HEIGHT 128
 #define PLAYER_WIDTH 11
 #define PLAYER_HEIGHT 8
-#define ALIEN_ROWS 3
-#define ALIEN_COLS 6
+#define ALIEN_MAX_ROWS 6
+#define ALIEN_MAX_COLS 11
 #define ALIEN_WIDTH 8
 #define ALIEN_HEIGHT 8
-#define ALIEN_SPACING_X 12
-#define ALIEN_SPACING_Y 12
 #define BULLET_WIDTH 2
 #define BULLET_HEIGHT 5
-#define MAX_BULLETS 3
-#define MAX_ALIEN_BULLETS 2
+#define MAX_BULLETS 3 // Player shots in flight
+#define BULLET_POOL_SIZE 16 // Capacity of each side's bullet pool
+#define EFFECT_POOL_SIZE 8
+#define EXPLOSION_MS 150
 #define PLAYER_SPEED 2
 #define BULLET_SPEED 3
 #define SHIELD_COUNT 3
 #define SHIELD_WIDTH 16
 #define SHIELD_HEIGHT 8
+#define SHIELD_FIRST_X 20 // Center of the leftmost shield
+#define SHIELD_SPACING (SCREEN_WIDTH / SHIELD_COUNT)
+#define SHIELD_Y (SCREEN_HEIGHT - 30)
+#define FORMATION_LEFT 10
+#define LEVEL_PAUSE 2300 // ms between clearing a wave and the next one
+
+#ifndef INVADERS_STRESS
+#define INVADERS_STRESS 0 // Set to 1 to play every wave as a full formation firing 16 bullets, without a game over
+#endif
 
 // Colors
 #define BLACK 0x0000
@@ -33,15 +50,40 @@
 #define GREEN 0x07E0
 #define RED 0xF800
 
+// One bit per column, bit 0 leftmost
+typedef uint16_t AlienRow;
+static_assert(ALIEN_MAX_COLS <= 16, "AlienRow holds at most 16 columns");
+
+// Formation size, speed and fire rate of one level
+struct Wave {
+  uint8_t rows, cols;
+  uint8_t spacingX, spacingY;
+  uint16_t moveMs;      // Time between formation steps
+  uint16_t fireMs;      // Minimum time between alien shots
+  uint8_t fireChance;   // Percent chance of a shot on each step
+  uint8_t alienBullets; // Alien shots in flight at once
+};
+
+// Levels past the end repeat the last wave, stepping faster each time
+static constexpr Wave WAVES[] = {
+  { 3,  6, 12, 12, 500, 800, 30, 2 },
+  { 4,  7, 12, 11, 450, 700, 35, 3 },
+  { 4,  8, 11, 11, 400, 600, 40, 4 },
+  { 5,  9, 11, 10, 350, 500, 45, 5 },
+  { 5, 10, 10, 10, 300, 450, 50, 6 },
+  { 6, 11, 10, 10, 250, 400, 55, 8 },
+};
+static constexpr int WAVE_COUNT = sizeof(WAVES) / sizeof(WAVES[0]);
+#define WAVE_MIN_MOVE_MS 100
+
 // Game objects
-struct Alien {
+struct Bullet {
   int x, y;
-  boolean alive;
 };
 
-struct Bullet {
+struct Explosion {
   int x, y;
-  boolean active;
+  unsigned long endsAt; // simTime when it is erased
 };
 
 struct Shield {
@@ -50,7 +92,7 @@ struct Shield {
 };
 
 // Player bitmap (11x8)
-static const unsigned char PROGMEM playerBitmap[] = {
+static constexpr unsigned char PROGMEM playerBitmap[] = {
   0b00001000, 0b00000000,
   0b00011100, 0b00000000,
   0b00111110, 0b00000000,
@@ -61,6 +103,29 @@ static const unsigned char PROGMEM playerBitmap[] = {
   0b11111111, 0b10000000
 };
 
+// Explosion bitmap (8x8)
+static constexpr unsigned char PROGMEM explosionBitmap[] = {
+  0b10001001,
+  0b01010010,
+  0b00100100,
+  0b11000011,
+  0b00100100,
+  0b01001010,
+  0b10010001,
+  0b00010000
+};
+
+// Pre-converted sprites for the blitter
+static constexpr SpriteTable<PLAYER_WIDTH * PLAYER_HEIGHT> playerPixels =
+  monoSpritePixels<PLAYER_WIDTH, PLAYER_HEIGHT>(playerBitmap, GREEN);
+static constexpr SpriteTable<PLAYER_HEIGHT> playerMasks = monoSpriteMasks<PLAYER_WIDTH, PLAYER_HEIGHT>(playerBitmap);
+static constexpr Sprite playerSprite = { PLAYER_WIDTH, PLAYER_HEIGHT, playerPixels.v, playerMasks.v };
+
+static constexpr SpriteTable<ALIEN_WIDTH * ALIEN_HEIGHT> explosionPixels =
+  monoSpritePixels<ALIEN_WIDTH, ALIEN_HEIGHT>(explosionBitmap, 0xFFE0); // Yellow
+static constexpr SpriteTable<ALIEN_HEIGHT> explosionMasks = monoSpriteMasks<ALIEN_WIDTH, ALIEN_HEIGHT>(explosionBitmap);
+static constexpr Sprite explosionSprite = { ALIEN_WIDTH, ALIEN_HEIGHT, explosionPixels.v, explosionMasks.v };
+
 // Alien bitmap (8x8)
 static const unsigned char PROGMEM alienBitmap[] = {
   0b00011000,
@@ -73,7 +138,7 @@ static const unsigned char PROGMEM alienBitmap[] = {
   0b10000001
 };
 
-class SpaceInvador {
+class SpaceInvador : public Game {
 public:
   // Game states
   enum GameState {
@@ -82,12 +147,13 @@ public:
     GAME_OVER
   };
   
-  SpaceInvador(Adafruit_ST7735 &display, int buttonPin, int vibrationPin, int xPin, int yPin) : 
-    tft(display), buttonPin(buttonPin), vibrationPin(vibrationPin), xPin(xPin), yPin(yPin) {
+  SpaceInvador(FrameBuffer &display, InputHandler &input) : 
+    tft(display), inputHandler(input), motor(Vibrationmotor_PIN),
+    formation(alienBitmap, ALIEN_HEIGHT, WAVES[0].spacingX, WHITE, BLACK) {
     // Initialize game variables
     currentState = START;
     gameOverScreenShown = false;
-    buttonWasPressed = false;
+    menuRequested = false;
     playerX = 0;
     oldPlayerX = 0;
     score = 0;
@@ -95,61 +161,55 @@ public:
     lastShot = 0;
     lastAlienMove = 0;
     lastAlienShot = 0;
+    levelPaused = false;
+    levelResumeAt = 0;
     alienDirection = 1;
+    level = 0;
+    wave = waveFor(0);
+    formationX = FORMATION_LEFT;
+    formationY = 0;
+    sweepRow = 0;
+    sweepDX = sweepDY = 0;
+    memset(aliveMask, 0, sizeof(aliveMask));
     highScore = 0;
-    
-    // Read high score from EEPROM
-    highScore = EEPROM.read(highScoreAddress) | (EEPROM.read(highScoreAddress + 1) << 8);
   }
   
-  void init() {
+  void init() override {
+    // Read high score from EEPROM (not in the constructor, which runs
+    // before setup() has brought up the hardware)
+    highScore = EEPROM.read(highScoreAddress) | (EEPROM.read(highScoreAddress + 1) << 8);
+    menuRequested = false;
+    
     // Initialize player position
     playerX = (SCREEN_WIDTH - PLAYER_WIDTH) / 2;
     oldPlayerX = playerX;
     
     // Initialize aliens
-    for (int row = 0; row < ALIEN_ROWS; row++) {
-      for (int col = 0; col < ALIEN_COLS; col++) {
-        int index = row * ALIEN_COLS + col;
-        aliens[index].x = 10 + col * ALIEN_SPACING_X;
-        aliens[index].y = 20 + row * ALIEN_SPACING_Y;
-        aliens[index].alive = true;
-      }
-    }
+    level = 0;
+    startWave(20);
     
     // Initialize shields
-    for (int i = 0; i < SHIELD_COUNT; i++) {
-      shields[i].x = 20 + i * (SCREEN_WIDTH / SHIELD_COUNT);
-      shields[i].y = SCREEN_HEIGHT - 30;
-      shields[i].health = 3;
-    }
+    resetShields();
     
-    // Initialize bullets
-    for (int i = 0; i < MAX_BULLETS; i++) {
-      bullets[i].active = false;
-    }
-    
-    // Initialize alien bullets
-    for (int i = 0; i < MAX_ALIEN_BULLETS; i++) {
-      alienBullets[i].active = false;
-    }
+    // Initialize bullets and effects
+    clearPools();
     
     // Reset game state
     score = 0;
     lives = 3;
     currentState = PLAYING;
+    levelPaused = false;
     
     // Clear screen
     tft.fillScreen(BLACK);
+    formation.reset();
     
     // Draw initial game elements
     drawScore();
     drawLives();
     drawPlayer();
     
-    for (int i = 0; i < ALIEN_ROWS * ALIEN_COLS; i++) {
-      drawAlien(i);
-    }
+    drawFormation();
     
     for (int i = 0; i < SHIELD_COUNT; i++) {
       drawShield(i);
@@ -157,7 +217,11 @@ public:
   }
   
   // Main update function to be called from the main loop
-  void update(bool buttonPressed, bool buttonReleased) {
+  void update(unsigned long dt, InputHandler &input) override {
+    simTime += dt;
+    
+    bool buttonPressed = input.buttonPressed;
+    
     switch (currentState) {
       case START:
         handleStartState(buttonPressed);
@@ -166,11 +230,16 @@ public:
         handlePlayingState(buttonPressed);
         break;
       case GAME_OVER:
-        handleGameOverState(buttonPressed, buttonReleased);
+        handleGameOverState(input);
         break;
     }
   }
   
+  // Drawing happens incrementally as objects move in update()
+  void render(Fixed8) override {}
+  
+  bool wantsMenu() const override { return menuRequested; }
+  
   // Get current game state
   GameState getState() {
     return currentState;
@@ -202,17 +271,15 @@ public:
   
   // Handle playing state
   void handlePlayingState(bool buttonPressed) {
-    static unsigned long lastFrameTime = 0;
-    const unsigned long frameInterval = 1000 / 60; // 60 FPS
-    
-    unsigned long currentTime = millis();
-    if (currentTime - lastFrameTime < frameInterval) {
-      return; // Skip frame if not enough time has passed
+    // Play is paused between waves
+    if (levelPaused) {
+      if ((long)(simTime - levelResumeAt) < 0) return;
+      levelPaused = false;
+      nextLevel();
     }
-    lastFrameTime = currentTime;
     
     // Read joystick for player movement
-    int xValue = analogRead(xPin);
+    int xValue = inputHandler.xValue;
     
     // Store old position for erasing
     oldPlayerX = playerX;
@@ -231,9 +298,9 @@ public:
     }
     
     // Shoot when button pressed (with debounce)
-    if (buttonPressed && millis() - lastShot > 200) {
+    if (buttonPressed && simTime - lastShot > 200) {
       firePlayerBullet();
-      lastShot = millis();
+      lastShot = simTime;
     }
     
     // Update bullets
@@ -242,15 +309,19 @@ public:
     // Update alien bullets
     updateAlienBullets();
     
-    // Move aliens periodically
-    if (millis() - lastAlienMove > 500) {
-      moveAliens();
-      lastAlienMove = millis();
+    // Clear explosions that have run their time
+    updateExplosions();
+    
+    // Move aliens periodically, one row at a time; a sweep of every row
+    // takes the wave's moveMs
+    if (simTime - lastAlienMove > (unsigned long)(wave.moveMs / liveRowCount())) {
+      bool newSweep = moveAliens();
+      lastAlienMove = simTime;
       
-      // Randomly fire alien bullets
-      if (random(100) < 30 && millis() - lastAlienShot > 800) {
+      // Randomly fire alien bullets, once a sweep
+      if (newSweep && random(100) < wave.fireChance && simTime - lastAlienShot > wave.fireMs) {
         fireAlienBullet();
-        lastAlienShot = millis();
+        lastAlienShot = simTime;
       }
     }
     
@@ -261,71 +332,33 @@ public:
   }
   
   // Handle game over state
-  void handleGameOverState(bool buttonPressed, bool buttonReleased) {
+  void handleGameOverState(const InputHandler &input) {
     if (!gameOverScreenShown) {
       gameOverScreen();
       gameOverScreenShown = true;
+      gameOverInput.reset();
     }
     
-    if (buttonPressed && !buttonWasPressed) {
-      currentState = START;
-      gameOverScreenShown = false;
-      buttonWasPressed = true;
-    } else if (buttonReleased) {
-      buttonWasPressed = false;
-    }
-  }
-  
-  void draw() {
-    static unsigned long lastRenderTime = 0;
-    const unsigned long renderInterval = 1000 / 60; // 60 FPS
-    
-    unsigned long currentTime = millis();
-    if (currentTime - lastRenderTime < renderInterval) {
-      return; // Skip render if not enough time has passed
-    }
-    lastRenderTime = currentTime;
-    
-    if (currentState != PLAYING) return;
-    
-    // Draw all game elements
-    drawScore();
-    drawLives();
-    
-    for (int i = 0; i < SHIELD_COUNT; i++) {
-      if (shields[i].health > 0) {
-        drawShield(i);
-      }
-    }
-    
-    for (int i = 0; i < ALIEN_ROWS * ALIEN_COLS; i++) {
-      if (aliens[i].alive) {
-        drawAlien(i);
-      }
-    }
-    
-    drawPlayer();
-    
-    for (int i = 0; i < MAX_BULLETS; i++) {
-      if (bullets[i].active) {
-        tft.fillRect(bullets[i].x, bullets[i].y, BULLET_WIDTH, BULLET_HEIGHT, GREEN);
-      }
-    }
-    
-    for (int i = 0; i < MAX_ALIEN_BULLETS; i++) {
-      if (alienBullets[i].active) {
-        tft.fillRect(alienBullets[i].x, alienBullets[i].y, BULLET_WIDTH, BULLET_HEIGHT, RED);
-      }
+    switch (gameOverInput.update(input)) {
+      case GameOverInput::RESTART:
+        currentState = START;
+        gameOverScreenShown = false;
+        break;
+      case GameOverInput::MENU:
+        menuRequested = true;
+        break;
+      case GameOverInput::NONE:
+        break;
     }
   }
   
   bool isRunning() { return currentState == PLAYING; }
-  void start() { currentState = PLAYING; initGame(); }
   void stop() { currentState = GAME_OVER; }
   
 // **Screen Display Functions**
 void showStartScreen() {
     tft.fillScreen(BLACK);
+    formation.reset();
     
     // Calculate center positions
     int titleWidth = 12 * 6 * 2; // 12 chars * 6px * text size 2
@@ -359,6 +392,7 @@ void showStartScreen() {
   
   void gameOverScreen() {
     tft.fillScreen(BLACK);
+    formation.reset();
     
     // Center "GAME OVER" text
     int gameOverWidth = 9 * 6 * 2; // 9 chars * 6px * text size 2
@@ -402,6 +436,11 @@ void showStartScreen() {
       tft.print(highScoreText);
     }
     
+    int menuWidth = 13 * 6; // "Hold for menu" is 13 chars
+    tft.setTextColor(WHITE);
+    tft.setCursor((SCREEN_WIDTH - menuWidth) / 2, 110);
+    tft.print("Hold for menu");
+    
     // Center restart prompt
     int restartWidth = 22 * 6; // "Press button to restart" is 22 chars
     int restartX = (SCREEN_WIDTH - restartWidth) / 2;
@@ -414,85 +453,50 @@ void showStartScreen() {
     tft.drawRect(5, 5, SCREEN_WIDTH-10, SCREEN_HEIGHT-10, WHITE);
     
     // Vibration feedback
-    digitalWrite(vibrationPin, HIGH);
-    delay(500);
-    digitalWrite(vibrationPin, LOW);
-  }
-  
-  // **Initialization Function**
-  void initGame() {
-    // Initialize player
-    playerX = (SCREEN_WIDTH - PLAYER_WIDTH) / 2;
-    oldPlayerX = playerX;
-    
-    // Initialize aliens
-    for (int row = 0; row < ALIEN_ROWS; row++) {
-      for (int col = 0; col < ALIEN_COLS; col++) {
-        int index = row * ALIEN_COLS + col;
-        aliens[index].x = 10 + col * ALIEN_SPACING_X;
-        aliens[index].y = 15 + row * ALIEN_SPACING_Y;
-        aliens[index].alive = true;
-      }
-    }
-    
-    // Initialize bullets
-    for (int i = 0; i < MAX_BULLETS; i++) {
-      bullets[i].active = false;
-    }
-    
-    // Initialize alien bullets
-    for (int i = 0; i < MAX_ALIEN_BULLETS; i++) {
-      alienBullets[i].active = false;
-    }
-    
-    // Initialize shields
-    for (int i = 0; i < SHIELD_COUNT; i++) {
-      shields[i].x = 20 + i * ((SCREEN_WIDTH - 40) / (SHIELD_COUNT - 1));
-      shields[i].y = SCREEN_HEIGHT - 30;
-      shields[i].health = 3;
-    }
-    
-    // Reset game state
-    score = 0;
-    lives = 3;
-    alienDirection = 1;
-    
-    // Draw initial screen
-    tft.fillScreen(BLACK);
-    drawScore();
-    drawLives();
-    
-    // Draw shields
-    for (int i = 0; i < SHIELD_COUNT; i++) {
-      drawShield(i);
-    }
-    
-    // Draw aliens
-    for (int i = 0; i < ALIEN_ROWS * ALIEN_COLS; i++) {
-      if (aliens[i].alive) {
-        drawAlien(i);
-      }
-    }
-    
-    // Draw player
-    drawPlayer();
+    motor.pulse(500);
   }
   
   // **Drawing Functions**
   void drawPlayer() {
-    tft.drawBitmap(playerX, SCREEN_HEIGHT - PLAYER_HEIGHT - 10, playerBitmap, PLAYER_WIDTH, PLAYER_HEIGHT, GREEN);
+    tft.drawSprite(playerX, SCREEN_HEIGHT - PLAYER_HEIGHT - 10, playerSprite);
   }
   
   void erasePlayer() {
     tft.fillRect(oldPlayerX, SCREEN_HEIGHT - PLAYER_HEIGHT - 10, PLAYER_WIDTH, PLAYER_HEIGHT, BLACK);
   }
   
-  void drawAlien(int index) {
-    tft.drawBitmap(aliens[index].x, aliens[index].y, alienBitmap, ALIEN_WIDTH, ALIEN_HEIGHT, WHITE);
+  // Rows from sweepRow down have already taken this sweep's step
+  int alienX(int row, int col) {
+    return formationX + (row >= sweepRow ? sweepDX : 0) + col * wave.spacingX;
   }
+  int alienY(int row) { return formationY + (row >= sweepRow ? sweepDY : 0) + row * wave.spacingY; }
   
-  void eraseAlien(int index) {
-    tft.fillRect(aliens[index].x, aliens[index].y, ALIEN_WIDTH, ALIEN_HEIGHT, BLACK);
+  // Bring the aliens on screen up to date; only changed pixels are drawn
+  void drawFormation() {
+    int16_t rowX[ALIEN_MAX_ROWS], rowY[ALIEN_MAX_ROWS];
+    for (int row = 0; row < wave.rows; row++) {
+      rowX[row] = alienX(row, 0);
+      rowY[row] = alienY(row);
+    }
+    formation.draw(tft, rowX, rowY, aliveMask, wave.rows);
+  }
+  
+  // Rows with at least one live alien, at least 1
+  int liveRowCount() {
+    int rows = 0;
+    for (int row = 0; row < wave.rows; row++) {
+      if (aliveMask[row]) rows++;
+    }
+    return max(rows, 1);
+  }
+  
+  // Columns with at least one live alien
+  AlienRow liveColumns() {
+    AlienRow columns = 0;
+    for (int row = 0; row < wave.rows; row++) {
+      columns |= aliveMask[row];
+    }
+    return columns;
   }
   
   void drawShield(int index) {
@@ -526,173 +530,321 @@ void showStartScreen() {
   
   // **Game Logic Functions**
   void firePlayerBullet() {
-    for (int i = 0; i < MAX_BULLETS; i++) {
-      if (!bullets[i].active) {
-        bullets[i].x = playerX + PLAYER_WIDTH/2 - BULLET_WIDTH/2;
-        bullets[i].y = SCREEN_HEIGHT - PLAYER_HEIGHT - 10;
-        bullets[i].active = true;
-        
-        // Vibration feedback
-        digitalWrite(vibrationPin, HIGH);
-        delay(50);
-        digitalWrite(vibrationPin, LOW);
-        break;
-      }
-    }
+    if (bullets.count() >= MAX_BULLETS) return;
+    
+    Bullet *bullet = bullets.spawn();
+    bullet->x = playerX + PLAYER_WIDTH/2 - BULLET_WIDTH/2;
+    bullet->y = SCREEN_HEIGHT - PLAYER_HEIGHT - 10;
+    
+    // Vibration feedback
+    motor.pulse(50);
   }
   
   void fireAlienBullet() {
-    int aliveAliens[ALIEN_ROWS * ALIEN_COLS];
     int aliveCount = 0;
-    
-    for (int i = 0; i < ALIEN_ROWS * ALIEN_COLS; i++) {
-      if (aliens[i].alive) {
-        aliveAliens[aliveCount++] = i;
-      }
+    for (int row = 0; row < wave.rows; row++) {
+      aliveCount += __builtin_popcount(aliveMask[row]);
     }
+    if (aliveCount == 0) return;
     
-    if (aliveCount > 0) {
-      int alienIndex = aliveAliens[random(aliveCount)];
-      for (int i = 0; i < MAX_ALIEN_BULLETS; i++) {
-        if (!alienBullets[i].active) {
-          alienBullets[i].x = aliens[alienIndex].x + ALIEN_WIDTH/2 - BULLET_WIDTH/2;
-          alienBullets[i].y = aliens[alienIndex].y + ALIEN_HEIGHT;
-          alienBullets[i].active = true;
-          break;
-        }
-      }
+    // Find the n-th live alien: skip whole rows by their popcount, then
+    // drop the lowest set bits of the row it falls in
+    int n = random(aliveCount);
+    int row = 0;
+    while (n >= __builtin_popcount(aliveMask[row])) {
+      n -= __builtin_popcount(aliveMask[row]);
+      row++;
     }
+    unsigned int bits = aliveMask[row];
+    while (n-- > 0) {
+      bits &= bits - 1;
+    }
+    int col = __builtin_ctz(bits);
+    
+    if (alienBullets.count() >= wave.alienBullets) return;
+    
+    Bullet *bullet = alienBullets.spawn();
+    if (!bullet) return;
+    bullet->x = alienX(row, col) + ALIEN_WIDTH/2 - BULLET_WIDTH/2;
+    bullet->y = alienY(row) + ALIEN_HEIGHT;
+  }
+  
+  // Black out a bullet and let the formation repaint any alien pixels the
+  // erase covered; true when it touched the formation
+  boolean eraseBullet(const Bullet &bullet) {
+    tft.fillRect(bullet.x, bullet.y, BULLET_WIDTH, BULLET_HEIGHT, BLACK);
+    if (bullet.y + BULLET_HEIGHT <= alienY(0) ||
+        bullet.y >= alienY(wave.rows - 1) + ALIEN_HEIGHT) {
+      return false;
+    }
+    formation.invalidate(bullet.x, bullet.y, BULLET_WIDTH, BULLET_HEIGHT);
+    return true;
   }
   
   void updateBullets() {
-    for (int i = 0; i < MAX_BULLETS; i++) {
-      if (bullets[i].active) {
-        tft.fillRect(bullets[i].x, bullets[i].y, BULLET_WIDTH, BULLET_HEIGHT, BLACK);
-        bullets[i].y -= BULLET_SPEED;
-        
-        if (bullets[i].y < 0) {
-          bullets[i].active = false;
-          continue;
-        }
-        
-        boolean hit = false;
-        for (int j = 0; j < ALIEN_ROWS * ALIEN_COLS && !hit; j++) {
-          if (aliens[j].alive && collisionCheck(bullets[i].x, bullets[i].y, BULLET_WIDTH, BULLET_HEIGHT,
-                                                aliens[j].x, aliens[j].y, ALIEN_WIDTH, ALIEN_HEIGHT)) {
-            eraseAlien(j);
-            aliens[j].alive = false;
-            bullets[i].active = false;
-            hit = true;
-            score += 10;
-            drawScore();
-            
-            digitalWrite(vibrationPin, HIGH);
-            delay(30);
-            digitalWrite(vibrationPin, LOW);
-          }
-        }
-        
-        for (int j = 0; j < SHIELD_COUNT && !hit; j++) {
-          if (shields[j].health > 0 && collisionCheck(bullets[i].x, bullets[i].y, BULLET_WIDTH, BULLET_HEIGHT,
-                                                      shields[j].x - SHIELD_WIDTH/2, shields[j].y, SHIELD_WIDTH, SHIELD_HEIGHT)) {
-            bullets[i].active = false;
-            hit = true;
-            shields[j].health--;
-            drawShield(j);
-          }
-        }
+    boolean repaint = false;
+    for (int i = 0; i < bullets.count(); ) {
+      Bullet &bullet = bullets[i];
+      repaint |= eraseBullet(bullet);
+      bullet.y -= BULLET_SPEED;
+      
+      boolean hit = bullet.y < 0;
+      
+      int alien = hit ? -1 : alienAt(bullet.x, bullet.y, BULLET_WIDTH, BULLET_HEIGHT);
+      if (alien >= 0) {
+        killAlien(alien / ALIEN_MAX_COLS, alien % ALIEN_MAX_COLS);
+        hit = true;
+        score += 10;
+        drawScore();
         
-        if (bullets[i].active) {
-          tft.fillRect(bullets[i].x, bullets[i].y, BULLET_WIDTH, BULLET_HEIGHT, GREEN);
+        motor.pulse(30);
+      } else if (!hit) {
+        int shield = shieldAt(bullet.x, bullet.y, BULLET_WIDTH, BULLET_HEIGHT);
+        if (shield >= 0) {
+          hit = true;
+          shields[shield].health--;
+          drawShield(shield);
         }
       }
+      
+      if (hit) {
+        bullets.release(i); // The last bullet moves into slot i
+        continue;
+      }
+      tft.fillRect(bullet.x, bullet.y, BULLET_WIDTH, BULLET_HEIGHT, GREEN);
+      i++;
     }
+    if (repaint) drawFormation();
   }
   
   void updateAlienBullets() {
-    for (int i = 0; i < MAX_ALIEN_BULLETS; i++) {
-      if (alienBullets[i].active) {
-        tft.fillRect(alienBullets[i].x, alienBullets[i].y, BULLET_WIDTH, BULLET_HEIGHT, BLACK);
-        alienBullets[i].y += BULLET_SPEED;
-        
-        if (alienBullets[i].y > SCREEN_HEIGHT) {
-          alienBullets[i].active = false;
-          continue;
-        }
-        
-        if (collisionCheck(alienBullets[i].x, alienBullets[i].y, BULLET_WIDTH, BULLET_HEIGHT,
-                           playerX, SCREEN_HEIGHT - PLAYER_HEIGHT - 10, PLAYER_WIDTH, PLAYER_HEIGHT)) {
-          alienBullets[i].active = false;
-          playerHit();
-          continue;
-        }
-        
-        boolean hit = false;
-        for (int j = 0; j < SHIELD_COUNT && !hit; j++) {
-          if (shields[j].health > 0 && collisionCheck(alienBullets[i].x, alienBullets[i].y, BULLET_WIDTH, BULLET_HEIGHT,
-                                                      shields[j].x - SHIELD_WIDTH/2, shields[j].y, SHIELD_WIDTH, SHIELD_HEIGHT)) {
-            alienBullets[i].active = false;
-            hit = true;
-            shields[j].health--;
-            drawShield(j);
-          }
-        }
-        
-        if (alienBullets[i].active) {
-          tft.fillRect(alienBullets[i].x, alienBullets[i].y, BULLET_WIDTH, BULLET_HEIGHT, RED);
+    boolean repaint = false;
+    for (int i = 0; i < alienBullets.count(); ) {
+      Bullet &bullet = alienBullets[i];
+      repaint |= eraseBullet(bullet);
+      bullet.y += BULLET_SPEED;
+      
+      boolean hit = bullet.y > SCREEN_HEIGHT;
+      
+      if (!hit && collisionCheck(bullet.x, bullet.y, BULLET_WIDTH, BULLET_HEIGHT,
+                                 playerX, SCREEN_HEIGHT - PLAYER_HEIGHT - 10, PLAYER_WIDTH, PLAYER_HEIGHT)) {
+        hit = true;
+        playerHit();
+      }
+      
+      if (!hit) {
+        int shield = shieldAt(bullet.x, bullet.y, BULLET_WIDTH, BULLET_HEIGHT);
+        if (shield >= 0) {
+          hit = true;
+          shields[shield].health--;
+          drawShield(shield);
         }
       }
+      
+      if (hit) {
+        alienBullets.release(i);
+        continue;
+      }
+      tft.fillRect(bullet.x, bullet.y, BULLET_WIDTH, BULLET_HEIGHT, RED);
+      i++;
     }
+    if (repaint) drawFormation();
   }
   
-  void moveAliens() {
-    boolean changeDirection = false;
-    int leftX = SCREEN_WIDTH;
-    int rightX = 0;
-    
-    for (int i = 0; i < ALIEN_ROWS * ALIEN_COLS; i++) {
-      if (aliens[i].alive) {
-        leftX = min(leftX, aliens[i].x);
-        rightX = max(rightX, aliens[i].x + ALIEN_WIDTH);
+  void killAlien(int row, int col) {
+    aliveMask[row] &= ~(1u << col);
+    drawFormation();
+    
+    // No effect if the pool is full; the alien just vanishes
+    Explosion *explosion = explosions.spawn();
+    if (explosion) {
+      explosion->x = alienX(row, col);
+      explosion->y = alienY(row);
+      explosion->endsAt = simTime + EXPLOSION_MS;
+      tft.drawSprite(explosion->x, explosion->y, explosionSprite);
+    }
+  }
+  
+  void updateExplosions() {
+    boolean erased = false;
+    for (int i = 0; i < explosions.count(); ) {
+      Explosion &explosion = explosions[i];
+      if ((long)(simTime - explosion.endsAt) < 0) {
+        i++;
+        continue;
       }
+      
+      // The formation may have moved under it since; let it repaint there
+      tft.fillRect(explosion.x, explosion.y, ALIEN_WIDTH, ALIEN_HEIGHT, BLACK);
+      formation.invalidate(explosion.x, explosion.y, ALIEN_WIDTH, ALIEN_HEIGHT);
+      explosions.release(i);
+      erased = true;
     }
-    
-    if ((rightX >= SCREEN_WIDTH - 2 && alienDirection > 0) || (leftX <= 2 && alienDirection < 0)) {
-      changeDirection = true;
+    if (erased) {
+      drawFormation();
     }
-    
-    for (int i = 0; i < ALIEN_ROWS * ALIEN_COLS; i++) {
-      if (aliens[i].alive) {
-        eraseAlien(i);
-        
-        if (changeDirection) {
-          aliens[i].y += 8;
-          alienDirection *= -1;
-        } else {
-          aliens[i].x += alienDirection;
-        }
-        
-        drawAlien(i);
-        
-        if (aliens[i].y + ALIEN_HEIGHT >= SCREEN_HEIGHT - PLAYER_HEIGHT - 10) {
-          currentState = GAME_OVER;
-          return;
-        }
+  }
+  
+  void clearPools() {
+    bullets.clear();
+    alienBullets.clear();
+    explosions.clear();
+  }
+  
+  Wave waveFor(int index) {
+#if INVADERS_STRESS
+    (void)index; // Every level is the stress wave
+    Wave stress = { ALIEN_MAX_ROWS, ALIEN_MAX_COLS, 10, 10, 40, 0, 100, BULLET_POOL_SIZE };
+    return stress;
+#else
+    if (index < WAVE_COUNT) return WAVES[index];
+    
+    Wave last = WAVES[WAVE_COUNT - 1];
+    int moveMs = last.moveMs - 25 * (index - WAVE_COUNT + 1);
+    last.moveMs = max(moveMs, WAVE_MIN_MOVE_MS);
+    return last;
+#endif
+  }
+  
+  // Set up the formation for the current level with its top row at y
+  void startWave(int top) {
+    wave = waveFor(level);
+    formation.setSpacing(wave.spacingX);
+    resetFormation(top);
+  }
+  
+  // Next row up still to take this sweep's step, or -1
+  int nextSweepRow() {
+    for (int row = sweepRow - 1; row >= 0; row--) {
+      if (aliveMask[row]) return row;
+    }
+    return -1;
+  }
+  
+  // Step the next row of the formation, bottom row first as in the
+  // arcade. Only that row's edges change, so a step pushes a sixth of
+  // what moving the whole block would. True when it started a sweep.
+  boolean moveAliens() {
+    AlienRow columns = liveColumns();
+    if (!columns) return false;
+    
+    int row = nextSweepRow();
+    boolean newSweep = row < 0;
+    if (newSweep) {
+      // Every live row has taken the step; settle it and aim the next
+      formationX += sweepDX;
+      formationY += sweepDY;
+      sweepRow = wave.rows;
+      
+      // Edges of the formation are its outermost live columns
+      int leftX = formationX + __builtin_ctz(columns) * wave.spacingX;
+      int rightX = formationX + (31 - __builtin_clz(columns)) * wave.spacingX + ALIEN_WIDTH;
+      boolean changeDirection = (rightX >= SCREEN_WIDTH - 2 && alienDirection > 0) ||
+                                (leftX <= 2 && alienDirection < 0);
+      if (changeDirection) {
+        sweepDX = 0;
+        sweepDY = 8;
+        alienDirection = -alienDirection;
+      } else {
+        sweepDX = alienDirection;
+        sweepDY = 0;
       }
+      row = nextSweepRow();
+    }
+    sweepRow = row;
+    drawFormation();
+    
+    // A live alien reaching the player ends the game
+    if (alienY(row) + ALIEN_HEIGHT >= SCREEN_HEIGHT - PLAYER_HEIGHT - 10) {
+#if INVADERS_STRESS
+      // Keep the load up: the formation starts over instead of landing
+      resetFormation(20);
+      drawFormation();
+#else
+      currentState = GAME_OVER;
+#endif
     }
+    return newSweep;
   }
   
   bool collisionCheck(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2) {
     return (x1 < x2 + w2 && x1 + w1 > x2 && y1 < y2 + h2 && y1 + h1 > y2);
   }
   
+  // Place the full formation with its top row at y
+  void resetFormation(int top) {
+    formationX = FORMATION_LEFT;
+    formationY = top;
+    sweepRow = 0; // As if a sweep had just ended
+    sweepDX = sweepDY = 0;
+    for (int row = 0; row < ALIEN_MAX_ROWS; row++) {
+      aliveMask[row] = row < wave.rows ? (AlienRow)((1u << wave.cols) - 1) : 0;
+    }
+  }
+  
+  void resetShields() {
+    for (int i = 0; i < SHIELD_COUNT; i++) {
+      shields[i].x = SHIELD_FIRST_X + i * SHIELD_SPACING;
+      shields[i].y = SHIELD_Y;
+      shields[i].health = 3;
+    }
+  }
+  
+  // Live alien overlapping the rectangle, or -1.
+  // The formation is a uniform grid, so the rectangle maps straight to the
+  // few cells it can touch instead of being tested against every alien.
+  // Mid-sweep some rows are a step ahead; the lookup is widened by that
+  // step so it finds their cells too.
+  int alienAt(int x, int y, int w, int h) {
+    int left = x - formationX - max(sweepDX, 0);
+    int top = y - formationY - max(sweepDY, 0);
+    int right = x + w - formationX - min(sweepDX, 0);
+    int bottom = y + h - formationY - min(sweepDY, 0);
+    if (right <= 0 || bottom <= 0) return -1;
+    
+    // Cells whose sprite can reach the rectangle
+    int firstCol = max(0, (left - ALIEN_WIDTH) / wave.spacingX);
+    int lastCol = min(wave.cols - 1, (right - 1) / wave.spacingX);
+    int firstRow = max(0, (top - ALIEN_HEIGHT) / wave.spacingY);
+    int lastRow = min(wave.rows - 1, (bottom - 1) / wave.spacingY);
+    
+    for (int row = firstRow; row <= lastRow; row++) {
+      for (int col = firstCol; col <= lastCol; col++) {
+        if ((aliveMask[row] >> col & 1) && collisionCheck(x, y, w, h, alienX(row, col), alienY(row),
+                                                          ALIEN_WIDTH, ALIEN_HEIGHT)) {
+          return row * ALIEN_MAX_COLS + col;
+        }
+      }
+    }
+    return -1;
+  }
+  
+  // Standing shield overlapping the rectangle, or -1
+  int shieldAt(int x, int y, int w, int h) {
+    // All shields share one horizontal band
+    if (y + h <= SHIELD_Y || y >= SHIELD_Y + SHIELD_HEIGHT) return -1;
+    
+    // Nearest shield by center; the gaps are wider than a bullet
+    int index = (x + w / 2 - SHIELD_FIRST_X + SHIELD_SPACING / 2) / SHIELD_SPACING;
+    if (index < 0 || index >= SHIELD_COUNT || shields[index].health <= 0) return -1;
+    
+    if (!collisionCheck(x, y, w, h, shields[index].x - SHIELD_WIDTH/2, shields[index].y,
+                        SHIELD_WIDTH, SHIELD_HEIGHT)) {
+      return -1;
+    }
+    return index;
+  }
+  
   void playerHit() {
+#if INVADERS_STRESS
+    // A stress run never ends; hits still cost their redraw and pulse
+    if (lives > 1) lives--;
+#else
     lives--;
+#endif
     drawLives();
     
-    digitalWrite(vibrationPin, HIGH);
-    delay(200);
-    digitalWrite(vibrationPin, LOW);
+    motor.pulse(200);
     
     if (lives <= 0) {
       currentState = GAME_OVER;
@@ -700,12 +852,7 @@ void showStartScreen() {
   }
   
   bool aliensAllDead() {
-    for (int i = 0; i < ALIEN_ROWS * ALIEN_COLS; i++) {
-      if (aliens[i].alive) {
-        return false;
-      }
-    }
-    return true;
+    return liveColumns() == 0;
   }
   
   void levelComplete() {
@@ -715,28 +862,22 @@ void showStartScreen() {
     tft.setTextSize(1);
     tft.print("LEVEL COMPLETE!");
     
-    digitalWrite(vibrationPin, HIGH);
-    delay(100);
-    digitalWrite(vibrationPin, LOW);
-    delay(100);
-    digitalWrite(vibrationPin, HIGH);
-    delay(100);
-    digitalWrite(vibrationPin, LOW);
-    
-    delay(2000);
-    
-    // Reset aliens but keep score and lives
-    for (int row = 0; row < ALIEN_ROWS; row++) {
-      for (int col = 0; col < ALIEN_COLS; col++) {
-        int index = row * ALIEN_COLS + col;
-        aliens[index].x = 10 + col * ALIEN_SPACING_X;
-        aliens[index].y = 15 + row * ALIEN_SPACING_Y;
-        aliens[index].alive = true;
-      }
-    }
+    motor.pattern(100, 100, 2);
+    
+    // The next wave starts once LEVEL_PAUSE of play time has passed
+    levelPaused = true;
+    levelResumeAt = simTime + LEVEL_PAUSE;
+  }
+  
+  void nextLevel() {
+    // Next wave; score and lives carry over
+    level++;
+    startWave(15);
+    clearPools();
     
     // Redraw screen
     tft.fillScreen(BLACK);
+    formation.reset();
     drawScore();
     drawLives();
     
@@ -745,9 +886,7 @@ void showStartScreen() {
       drawShield(i);
     }
     
-    for (int i = 0; i < ALIEN_ROWS * ALIEN_COLS; i++) {
-      drawAlien(i);
-    }
+    drawFormation();
     
     drawPlayer();
   }
@@ -755,29 +894,38 @@ void showStartScreen() {
 
 private:
   // Game variables
-  Adafruit_ST7735 &tft;
-  int buttonPin;
-  int vibrationPin;
-  int xPin;
-  int yPin;
+  FrameBuffer &tft;
+  InputHandler &inputHandler;
+  VibrationMotor motor;
+  FormationRenderer formation;
   GameState currentState;
   
   int playerX, oldPlayerX;
   int score;
   int lives;
+  unsigned long simTime = 0; // Sum of update() steps; all gameplay timers use it
   unsigned long lastShot;
   unsigned long lastAlienMove;
   unsigned long lastAlienShot;
   int alienDirection;
+  int level;
+  Wave wave;
+  int formationX, formationY; // Top left of the (0, 0) cell, dead or alive, before this sweep
+  int sweepRow;               // Lowest row index that has taken this sweep's step
+  int sweepDX, sweepDY;       // This sweep's step
+  bool levelPaused;
+  unsigned long levelResumeAt; // simTime the next wave starts at
   boolean startScreenShown;
   boolean gameOverScreenShown;
-  boolean buttonWasPressed;
+  GameOverInput gameOverInput;
+  bool menuRequested;
   int highScore;
   const int highScoreAddress = 0;
 
-  Alien aliens[ALIEN_ROWS * ALIEN_COLS];
-  Bullet bullets[MAX_BULLETS];
-  Bullet alienBullets[MAX_ALIEN_BULLETS];
+  AlienRow aliveMask[ALIEN_MAX_ROWS];
+  ObjectPool<Bullet, BULLET_POOL_SIZE> bullets;
+  ObjectPool<Bullet, BULLET_POOL_SIZE> alienBullets;
+  ObjectPool<Explosion, EFFECT_POOL_SIZE> explosions;
   Shield shields[SHIELD_COUNT];
 };
 
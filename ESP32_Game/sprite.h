@@ -0,0 +1,88 @@
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <stdint.h>
+
+// Pre-converted RGB565 sprite, at most 16 pixels wide.
+// rowMasks has bit x set where pixel x of that row is opaque, so the
+// blitter copies whole runs of pixels instead of testing each one.
+struct Sprite {
+  uint8_t width, height;
+  const uint16_t *pixels;   // width * height, row-major
+  const uint16_t *rowMasks; // One per row
+};
+
+// Compile-time conversion of the existing bitmaps into Sprite tables.
+// Everything here is constexpr, so the tables are built by the compiler
+// and end up in flash:
+//
+//   static constexpr SpriteTable<64> fooPixels = monoSpritePixels<8, 8>(fooBitmap, WHITE);
+//   static constexpr SpriteTable<8> fooMasks = monoSpriteMasks<8, 8>(fooBitmap);
+//   static constexpr Sprite fooSprite = { 8, 8, fooPixels.v, fooMasks.v };
+namespace spritegen {
+
+template <int... I> struct Seq {};
+template <int N, int... I> struct MakeSeq : MakeSeq<N - 1, N - 1, I...> {};
+template <int... I> struct MakeSeq<0, I...> { typedef Seq<I...> type; };
+
+// Pixel i of a 1-bit bitmap laid out like drawBitmap() reads it: rows
+// padded to whole bytes, leftmost pixel in the top bit
+constexpr bool monoBit(const unsigned char *bits, int width, int i) {
+  return (bits[(i / width) * ((width + 7) / 8) + (i % width) / 8] & (0x80 >> (i % width % 8))) != 0;
+}
+
+constexpr uint16_t monoRowMask(const unsigned char *bits, int width, int y, int x) {
+  return x == width ? 0 : (uint16_t)((monoBit(bits, width, y * width + x) ? 1u << x : 0u) |
+                                     monoRowMask(bits, width, y, x + 1));
+}
+
+constexpr uint16_t keyedRowMask(const uint16_t *pixels, int width, uint16_t key, int y, int x) {
+  return x == width ? 0 : (uint16_t)((pixels[y * width + x] != key ? 1u << x : 0u) |
+                                     keyedRowMask(pixels, width, key, y, x + 1));
+}
+
+} // namespace spritegen
+
+template <int N>
+struct SpriteTable {
+  uint16_t v[N];
+};
+
+template <int... I>
+constexpr SpriteTable<sizeof...(I)> monoSpritePixels(const unsigned char *bits, int width,
+                                                      uint16_t color, spritegen::Seq<I...>) {
+  return {{ (uint16_t)(spritegen::monoBit(bits, width, I) ? color : 0)... }};
+}
+
+template <int... Y>
+constexpr SpriteTable<sizeof...(Y)> monoSpriteMasks(const unsigned char *bits, int width,
+                                                     spritegen::Seq<Y...>) {
+  return {{ spritegen::monoRowMask(bits, width, Y, 0)... }};
+}
+
+template <int... Y>
+constexpr SpriteTable<sizeof...(Y)> keyedSpriteMasks(const uint16_t *pixels, int width,
+                                                      uint16_t key, spritegen::Seq<Y...>) {
+  return {{ spritegen::keyedRowMask(pixels, width, key, Y, 0)... }};
+}
+
+// Pixels of a 1-bit bitmap in one color; clear bits are transparent
+template <int W, int H>
+constexpr SpriteTable<W * H> monoSpritePixels(const unsigned char *bits, uint16_t color) {
+  return monoSpritePixels(bits, W, color, typename spritegen::MakeSeq<W * H>::type());
+}
+
+template <int W, int H>
+constexpr SpriteTable<H> monoSpriteMasks(const unsigned char *bits) {
+  static_assert(W <= 16, "row masks are 16 bits wide");
+  return monoSpriteMasks(bits, W, typename spritegen::MakeSeq<H>::type());
+}
+
+// Masks for an RGB565 bitmap where pixels of the key color are transparent
+template <int W, int H>
+constexpr SpriteTable<H> keyedSpriteMasks(const uint16_t *pixels, uint16_t key) {
+  static_assert(W <= 16, "row masks are 16 bits wide");
+  return keyedSpriteMasks(pixels, W, key, typename spritegen::MakeSeq<H>::type());
+}
+
+#endif
@@ -0,0 +1,38 @@
+#include "telemetry.h"
+
+Telemetry::Telemetry(Stream &out, unsigned long minIntervalMs) :
+  out(out), minIntervalMs(minIntervalMs), droppedFrames(0) {
+  for (int i = 0; i < TELEMETRY_CHANNELS; i++) {
+    lastSent[i] = 0;
+  }
+}
+
+bool Telemetry::send(uint8_t channel, const void *payload, uint8_t length) {
+  if (channel >= TELEMETRY_CHANNELS || length > TELEMETRY_MAX_PAYLOAD) return false;
+
+  unsigned long now = millis();
+  if (now - lastSent[channel] < minIntervalMs) return false;
+
+  uint8_t frame[TELEMETRY_MAX_PAYLOAD + 4];
+  frame[0] = TELEMETRY_SYNC;
+  frame[1] = channel;
+  frame[2] = length;
+
+  uint8_t checksum = channel ^ length;
+  const uint8_t *bytes = static_cast<const uint8_t *>(payload);
+  for (uint8_t i = 0; i < length; i++) {
+    frame[3 + i] = bytes[i];
+    checksum ^= bytes[i];
+  }
+  frame[3 + length] = checksum;
+
+  size_t frameLength = length + 4;
+  if (out.availableForWrite() < (int)frameLength) {
+    droppedFrames++;
+    return false;
+  }
+
+  out.write(frame, frameLength);
+  lastSent[channel] = now;
+  return true;
+}
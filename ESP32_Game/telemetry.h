@@ -0,0 +1,37 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+
+#ifndef TELEMETRY_ENABLED
+#define TELEMETRY_ENABLED 0 // Set to 1 to stream binary telemetry over Serial
+#endif
+
+#define TELEMETRY_SYNC 0xA5
+#define TELEMETRY_CHANNELS 8
+#define TELEMETRY_MAX_PAYLOAD 32
+
+// Telemetry channels
+#define TELEMETRY_INPUT 0
+
+// Binary, rate-limited debug channel.
+// Frames are [sync, channel, length, payload..., xor checksum]. A frame is
+// dropped instead of sent when its channel sent one less than the minimum
+// interval ago, or when the stream's TX buffer has no room for it. That
+// way telemetry never stalls the loop. Any Stream works: the UART, or the
+// USB-CDC port (HWCDC) Serial maps to on the ESP32-C3.
+class Telemetry {
+public:
+  Telemetry(Stream &out, unsigned long minIntervalMs);
+
+  bool send(uint8_t channel, const void *payload, uint8_t length);
+  uint32_t dropped() const { return droppedFrames; }
+
+private:
+  Stream &out;
+  unsigned long minIntervalMs;
+  unsigned long lastSent[TELEMETRY_CHANNELS];
+  uint32_t droppedFrames;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "vibration.h"
+
+VibrationMotor::VibrationMotor(int pin) :
+  pin(pin), onMs(0), offMs(0), pulsesLeft(0), on(false), task(-1) {}
+
+void VibrationMotor::pulse(unsigned long durationMs) {
+  pattern(durationMs, 0, 1);
+}
+
+void VibrationMotor::pattern(unsigned long onMs, unsigned long offMs, uint8_t count) {
+  stop();
+  if (count == 0) return;
+
+  // Without a timer to end it a pulse would never stop; skip the pattern
+  task = scheduler.after(onMs, step, this);
+  if (task < 0) return;
+
+  this->onMs = onMs;
+  this->offMs = offMs;
+  pulsesLeft = count;
+  on = true;
+  digitalWrite(pin, HIGH);
+}
+
+void VibrationMotor::stop() {
+  scheduler.cancel(task);
+  task = -1;
+  pulsesLeft = 0;
+  on = false;
+  digitalWrite(pin, LOW);
+}
+
+void VibrationMotor::step(void *context) {
+  VibrationMotor *motor = static_cast<VibrationMotor *>(context);
+
+  if (motor->on) {
+    digitalWrite(motor->pin, LOW);
+    motor->on = false;
+    if (--motor->pulsesLeft == 0) {
+      motor->task = -1;
+      return;
+    }
+    motor->task = scheduler.after(motor->offMs, step, motor);
+    if (motor->task < 0) motor->pulsesLeft = 0; // Out of timers, end the pattern here
+  } else {
+    motor->task = scheduler.after(motor->onMs, step, motor);
+    if (motor->task < 0) {
+      motor->pulsesLeft = 0;
+      return;
+    }
+    digitalWrite(motor->pin, HIGH);
+    motor->on = true;
+  }
+}
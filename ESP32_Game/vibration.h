@@ -0,0 +1,27 @@
+#ifndef VIBRATION_H
+#define VIBRATION_H
+
+#include <Arduino.h>
+#include "scheduler.h"
+
+// Vibration motor driven by the scheduler instead of delay()
+class VibrationMotor {
+public:
+  VibrationMotor(int pin);
+
+  void pulse(unsigned long durationMs);
+  void pattern(unsigned long onMs, unsigned long offMs, uint8_t count);
+  void stop();
+
+private:
+  static void step(void *context);
+
+  int pin;
+  unsigned long onMs;
+  unsigned long offMs;
+  uint8_t pulsesLeft;
+  bool on;
+  int task;
+};
+
+#endif
@@ -0,0 +1,318 @@
+// Micro-benchmarks of the draw and simulation paths, timed on the host's
+// wall clock. Each prints one {"bench":...} line from
+// FrameProfiler::benchmark(); the pixel counts are exact, the times only
+// compare paths against each other on the same machine.
+//
+//   draw_bench [iterations]
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "config.h"
+#include "framebuffer.h"
+#include "frameprofiler.h"
+#include "gameloop.h"
+#include "gameregistry.h"
+#include "hostsim.h"
+
+#define BENCH_ITERATIONS 2000
+
+static Adafruit_ST7735 panel(TFT_CS, TFT_DC, TFT_MOSI, TFT_SCLK, TFT_RST);
+static GfxBackend backend(panel);
+static FrameBuffer frameBuffer(backend);
+static InputHandler inputHandler(Button_PIN, X_PIN, Y_PIN);
+
+// The same player sprite through Adafruit_GFX and through the blitter
+static void benchBitmap(FrameBuffer &fb, int i) {
+  fb.drawBitmap(i % 117, i % 120, playerBitmap, PLAYER_WIDTH, PLAYER_HEIGHT, GREEN);
+}
+
+static void benchSprite(FrameBuffer &fb, int i) {
+  fb.drawSprite(i % 117, i % 120, playerSprite);
+}
+
+// One FlappyBird pipe crossing the screen 2 px per step over the sky and
+// the (still) hills, composed a whole frame per step like the game. Each
+// row of a pipe is one color, so only its leading and trailing 2 px
+// columns change, and each goes out as one window per strip.
+static LineCompositor pipeScene(skyColors.v);
+
+static void composePipe(FrameBuffer &fb, int i) {
+  int x = SCREEN_WIDTH - (i * 2) % (SCREEN_WIDTH + PIPE_WIDTH);
+  int gapTop = SCREEN_HEIGHT / 2 - PIPE_GAP/2, gapBottom = SCREEN_HEIGHT / 2 + PIPE_GAP/2;
+  pipeScene.addStrip(x, PIPE_WIDTH, 0, gapTop, pipeShades.v, gapTop - 1);
+  pipeScene.addStrip(x, PIPE_WIDTH, gapBottom, SCREEN_HEIGHT, pipeShades.v, gapBottom);
+  pipeScene.compose(fb);
+}
+
+// Paint the scene once so the benchmark only sees the steps
+static void setUpPipeScroll() {
+  pipeScene.setLayers(flappyLayers, sizeof(flappyLayers) / sizeof(flappyLayers[0]));
+  composePipe(frameBuffer, 0);
+  frameBuffer.clearDirty();
+}
+
+static void benchPipeScroll(FrameBuffer &fb, int i) {
+  composePipe(fb, i + 1);
+}
+
+// Space Invaders' largest wave marching one pixel per sweep, a row per
+// step from the bottom up like the game, dropping at each edge, with a
+// few aliens shot out. Drawn the way the game did before
+// FormationRenderer (erase and redraw every live alien each step) and by
+// scanline difference; the pixel counts are what each flush would push.
+struct FormationMarch {
+  Wave wave = WAVES[WAVE_COUNT - 1];
+  AlienRow rows[ALIEN_MAX_ROWS];
+  int x, y, direction; // Origin before this sweep
+  int sweepRow, dx, dy; // Rows from sweepRow down have taken the step (dx, dy)
+  int16_t rowX[ALIEN_MAX_ROWS], rowY[ALIEN_MAX_ROWS];
+
+  // Move one row; false when it starts over at the top
+  bool step(int i) {
+    if (i == 0 || y > 60) {
+      for (int r = 0; r < wave.rows; r++) {
+        rows[r] = (AlienRow)((1u << wave.cols) - 1) & ~(AlienRow)(0x21 << r); // Two gaps per row
+      }
+      x = FORMATION_LEFT;
+      y = 20;
+      direction = 1;
+      sweepRow = 0;
+      dx = dy = 0;
+      place();
+      return false;
+    }
+    if (sweepRow == 0) {
+      x += dx;
+      y += dy;
+      sweepRow = wave.rows;
+      int right = x + (wave.cols - 1) * wave.spacingX + ALIEN_WIDTH;
+      if ((right >= SCREEN_WIDTH - 2 && direction > 0) || (x <= 2 && direction < 0)) {
+        dx = 0;
+        dy = 8;
+        direction = -direction;
+      } else {
+        dx = direction;
+        dy = 0;
+      }
+    }
+    sweepRow--;
+    place();
+    return true;
+  }
+
+  void place() {
+    for (int r = 0; r < wave.rows; r++) {
+      rowX[r] = x + (r >= sweepRow ? dx : 0);
+      rowY[r] = y + r * wave.spacingY + (r >= sweepRow ? dy : 0);
+    }
+  }
+
+  template <typename F>
+  void forEachAlien(const int16_t *originX, const int16_t *originY, F f) {
+    for (int r = 0; r < wave.rows; r++) {
+      for (AlienRow bits = rows[r]; bits; bits &= bits - 1) {
+        f(originX[r] + __builtin_ctz(bits) * wave.spacingX, originY[r]);
+      }
+    }
+  }
+};
+
+static void benchFormationLegacy(FrameBuffer &fb, int i) {
+  static FormationMarch march;
+  int16_t oldX[ALIEN_MAX_ROWS], oldY[ALIEN_MAX_ROWS];
+  memcpy(oldX, march.rowX, sizeof(oldX));
+  memcpy(oldY, march.rowY, sizeof(oldY));
+  if (march.step(i)) {
+    march.forEachAlien(oldX, oldY, [&](int x, int y) { fb.fillRect(x, y, ALIEN_WIDTH, ALIEN_HEIGHT, BLACK); });
+  } else {
+    fb.fillScreen(BLACK);
+  }
+  march.forEachAlien(march.rowX, march.rowY, [&](int x, int y) {
+    fb.drawBitmap(x, y, alienBitmap, ALIEN_WIDTH, ALIEN_HEIGHT, WHITE);
+  });
+}
+
+static void benchFormationDiff(FrameBuffer &fb, int i) {
+  static FormationMarch march;
+  static FormationRenderer formation(alienBitmap, ALIEN_HEIGHT, march.wave.spacingX, WHITE, BLACK);
+  if (!march.step(i)) {
+    fb.fillScreen(BLACK);
+    formation.reset();
+  }
+  formation.draw(fb, march.rowX, march.rowY, march.rows, march.wave.rows);
+}
+
+// Space Invaders collision tests for a full pool of bullets against the
+// largest wave: the grid lookup the game uses (alienAt/shieldAt) and the
+// scan it replaced, which tested every alien and every shield in turn.
+// Both count their hits, so main() can check they agree.
+#define COLLISION_BULLETS BULLET_POOL_SIZE
+
+// What the scan walked: one entry per alien, dead or alive
+struct ScanAlien {
+  int x, y;
+  bool alive;
+};
+
+static SpaceInvador *collisionGame;
+static ScanAlien scanAliens[ALIEN_MAX_ROWS * ALIEN_MAX_COLS];
+static int scanAlienCount;
+static uint32_t gridHits, scanHits;
+
+static void setUpCollisions() {
+  collisionGame = new SpaceInvador(frameBuffer, inputHandler);
+  SpaceInvador &game = *collisionGame;
+  game.init();
+  // Clear waves until the last, 6x11, one is up
+  for (int level = 1; level < WAVE_COUNT; level++) {
+    game.levelComplete();
+    for (int t = 0; t <= LEVEL_PAUSE; t += SIM_STEP_MS) {
+      game.update(SIM_STEP_MS, inputHandler);
+    }
+  }
+  game.clearPools();
+  game.resetShields();
+  frameBuffer.clearDirty();
+
+  const Wave &wave = WAVES[WAVE_COUNT - 1];
+  scanAlienCount = wave.rows * wave.cols;
+  for (int j = 0; j < scanAlienCount; j++) {
+    int row = j / wave.cols, col = j % wave.cols;
+    scanAliens[j] = { game.alienX(row, col), game.alienY(row), true };
+  }
+}
+
+// Bullet b of iteration i, spread over the formation and the shield band
+static void collisionBullet(int b, int i, int &x, int &y) {
+  x = (b * 37 + i * 3) % (SCREEN_WIDTH - BULLET_WIDTH);
+  y = (b * 23 + i * 5) % (SCREEN_HEIGHT - BULLET_HEIGHT);
+}
+
+static void benchCollisionGrid(FrameBuffer &, int i) {
+  SpaceInvador &game = *collisionGame;
+  for (int b = 0; b < COLLISION_BULLETS; b++) {
+    int x, y;
+    collisionBullet(b, i, x, y);
+    if (game.alienAt(x, y, BULLET_WIDTH, BULLET_HEIGHT) >= 0 ||
+        game.shieldAt(x, y, BULLET_WIDTH, BULLET_HEIGHT) >= 0) {
+      gridHits++;
+    }
+  }
+}
+
+static void benchCollisionScan(FrameBuffer &, int i) {
+  SpaceInvador &game = *collisionGame;
+  for (int b = 0; b < COLLISION_BULLETS; b++) {
+    int x, y;
+    collisionBullet(b, i, x, y);
+    bool hit = false;
+    for (int j = 0; j < scanAlienCount && !hit; j++) {
+      hit = scanAliens[j].alive && game.collisionCheck(x, y, BULLET_WIDTH, BULLET_HEIGHT, scanAliens[j].x,
+                                                       scanAliens[j].y, ALIEN_WIDTH, ALIEN_HEIGHT);
+    }
+    for (int j = 0; j < SHIELD_COUNT && !hit; j++) {
+      hit = game.collisionCheck(x, y, BULLET_WIDTH, BULLET_HEIGHT,
+                                SHIELD_FIRST_X + j * SHIELD_SPACING - SHIELD_WIDTH/2, SHIELD_Y,
+                                SHIELD_WIDTH, SHIELD_HEIGHT);
+    }
+    if (hit) scanHits++;
+  }
+}
+
+// Snake ticks on arenas of growing size; the time per tick should not grow
+template <int GridSize>
+static void benchSnakeTick(FrameBuffer &, int i) {
+  static BasicSnake<GridSize> snake(&inputHandler);
+  if (i == 0 || snake.isGameOver()) snake.reset();
+  snake.update();
+}
+
+// The same ticks steered by the autopilot; the difference to snakeTick is
+// the planner's cost per tick
+template <int GridSize>
+static void benchSnakeAutopilot(FrameBuffer &, int i) {
+  static BasicSnake<GridSize> snake(&inputHandler);
+  static SnakeAutopilot<GridSize> autopilot(snake);
+  if (i == 0 || snake.isGameOver()) {
+    snake.reset();
+    autopilot.reset();
+  }
+  autopilot.steer(inputHandler);
+  snake.update();
+}
+
+// Breakout balls sweeping through a brick field, at a few speeds (pixels
+// per step) and ball counts; a full-width paddle keeps them in play
+template <int Speed, int Balls>
+static void benchBrickSweep(FrameBuffer &, int i) {
+  static BrickField field;
+  static Ball balls[Balls];
+  static const Rect floor = { 0, FRAMEBUFFER_HEIGHT - 8, FRAMEBUFFER_WIDTH, 1 };
+  if (i == 0 || field.isCleared()) {
+    field.fill();
+    for (int b = 0; b < Balls; b++) {
+      balls[b] = { Fixed8(8 + b * 29), Fixed8(FRAMEBUFFER_HEIGHT / 2), Fixed8(Speed), Fixed8(-Speed) };
+    }
+  }
+  for (int b = 0; b < Balls; b++) {
+    field.sweep(balls[b], floor, Fixed8(Speed));
+  }
+}
+
+// Breakout stress: a full pool of balls, one step plus the batched ball
+// redraw per iteration, which has to fit well inside a frame
+static void benchBallStress(FrameBuffer &fb, int i) {
+  static BrickField field;
+  static BallPool pool;
+  static const Rect floor = { 0, FRAMEBUFFER_HEIGHT - 8, FRAMEBUFFER_WIDTH, 1 };
+  if (i == 0 || field.isCleared() || pool.count() < MAX_BALLS) {
+    field.fill();
+    pool.clear();
+    for (int b = 0; b < MAX_BALLS; b++) {
+      pool.spawn((2 + b * 31) % 124, 60 + b % 40, b % 2 ? 1 + b % 2 : -1, -(1 + b % 3));
+    }
+    pool.forgetDrawn();
+  }
+  int16_t hitX, hitY;
+  pool.advance(field, floor, Fixed8(2), hitX, hitY);
+  field.drawChanges(fb);
+  pool.draw(fb, WHITE, BLACK);
+}
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? atoi(argv[1]) : BENCH_ITERATIONS;
+
+  sim::reset();
+  panel.initR(INITR_144GREENTAB);
+  inputHandler.begin();
+
+  FixedStepLoop loop(SIM_STEP_MS, MAX_CATCH_UP_STEPS);
+  FrameProfiler profiler(frameBuffer, loop.stats(), Serial, sim::wallMicros);
+
+  profiler.benchmark("drawBitmap", benchBitmap, iterations);
+  profiler.benchmark("drawSprite", benchSprite, iterations);
+  setUpPipeScroll();
+  profiler.benchmark("pipeScroll", benchPipeScroll, iterations);
+  profiler.benchmark("formationLegacy", benchFormationLegacy, iterations);
+  profiler.benchmark("formationDiff", benchFormationDiff, iterations);
+  setUpCollisions();
+  profiler.benchmark("collisionGrid", benchCollisionGrid, iterations);
+  profiler.benchmark("collisionScan", benchCollisionScan, iterations);
+  profiler.benchmark("snakeTick16", benchSnakeTick<16>, iterations);
+  profiler.benchmark("snakeTick64", benchSnakeTick<64>, iterations);
+  profiler.benchmark("snakeTick256", benchSnakeTick<256>, iterations);
+  profiler.benchmark("snakeAutopilot16", benchSnakeAutopilot<16>, iterations);
+  profiler.benchmark("snakeAutopilot64", benchSnakeAutopilot<64>, iterations);
+  profiler.benchmark("brickSweep1x1", benchBrickSweep<1, 1>, iterations);
+  profiler.benchmark("brickSweep4x1", benchBrickSweep<4, 1>, iterations);
+  profiler.benchmark("brickSweep8x1", benchBrickSweep<8, 1>, iterations);
+  profiler.benchmark("brickSweep1x4", benchBrickSweep<1, 4>, iterations);
+  profiler.benchmark("brickSweep4x4", benchBrickSweep<4, 4>, iterations);
+  profiler.benchmark("ballStress64", benchBallStress, iterations);
+
+  if (gridHits != scanHits) {
+    fprintf(stderr, "collision paths disagree: grid %u hits, scan %u\n", gridHits, scanHits);
+    return 1;
+  }
+  return 0;
+}
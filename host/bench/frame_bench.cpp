@@ -0,0 +1,69 @@
+// Deterministic frame benchmark: every game in GAME_REGISTRY played by
+// the same scripted player for a fixed number of frames on the virtual
+// clock. Prints one FrameProfiler line per game; everything but the
+// wall-clock "us" figures is reproducible bit for bit.
+//
+//   frame_bench [frames]
+
+#include <Arduino.h>
+#include "gameharness.h"
+#include "gameregistry.h"
+
+#define BENCH_FRAMES 3000
+#define BENCH_FRAME_MS 17 // A little over a step, so alpha and catch-up get exercised
+
+#define IDLE SIM_ANALOG_IDLE
+#define LOW_ SIM_ANALOG_MIN
+#define HIGH_ SIM_ANALOG_MAX
+
+// Start, then strafe both ways firing
+static const sim::ScriptStep invadersScript[] = {
+  { 3, IDLE, IDLE, true }, { 30, HIGH_, IDLE, false }, { 3, HIGH_, IDLE, true },
+  { 30, HIGH_, IDLE, false }, { 3, LOW_, IDLE, true }, { 30, LOW_, IDLE, false },
+  { 3, LOW_, IDLE, true }, { 30, LOW_, IDLE, false },
+};
+
+// Flap about three times a second
+static const sim::ScriptStep flappyScript[] = {
+  { 3, IDLE, IDLE, true }, { 17, IDLE, IDLE, false },
+};
+
+// Start, then run a square
+static const sim::ScriptStep snakeScript[] = {
+  { 3, IDLE, IDLE, true }, { 40, HIGH_, IDLE, false }, { 40, IDLE, LOW_, false },
+  { 40, LOW_, IDLE, false }, { 40, IDLE, HIGH_, false },
+};
+
+// Start, then sweep the paddle across
+static const sim::ScriptStep breakoutScript[] = {
+  { 3, IDLE, IDLE, true }, { 45, HIGH_, IDLE, false }, { 45, LOW_, IDLE, false },
+};
+
+struct GameScript {
+  const sim::ScriptStep *steps;
+  int count;
+};
+
+#define SCRIPT(steps) { steps, sizeof(steps) / sizeof(steps[0]) }
+
+// Same order as GAME_REGISTRY
+static const GameScript scripts[] = {
+  SCRIPT(invadersScript),
+  SCRIPT(flappyScript),
+  SCRIPT(snakeScript),
+  SCRIPT(breakoutScript),
+};
+static_assert(sizeof(scripts) / sizeof(scripts[0]) == GAME_COUNT, "one script per registered game");
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : BENCH_FRAMES;
+
+  static GameHarness harness;
+  bool ok = true;
+  for (int i = 0; i < GAME_COUNT; i++) {
+    Game *game = GAME_REGISTRY[i].create(harness.display(), harness.input());
+    ok &= harness.run(GAME_REGISTRY[i].name, *game, scripts[i].steps, scripts[i].count,
+                      frames, BENCH_FRAME_MS);
+  }
+  return ok ? 0 : 1;
+}
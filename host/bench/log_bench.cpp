@@ -0,0 +1,75 @@
+// Loop rate at the build's LOG_LEVEL: setup() and loop() from the sketch
+// on the virtual clock, with the menu scrolled and a game played, like
+// console_sim. Built once at the default level (log_bench) and once at
+// LOG_LEVEL_DEBUG (log_bench_debug); compare the two "fps" figures.
+//
+// Serial output is counted instead of printed. On the device println()
+// blocks once the UART TX FIFO is full, so each frame is charged the
+// time the bytes that did not fit take on the wire, on top of the
+// wall-clock time loop() took here. At the sketch's 115200 baud the
+// debug trace fits and only its formatting shows; pass a slower baud
+// (the console used to run at 9600) to see the UART take over.
+//
+//   log_bench [frames] [baud]
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "config.h"
+#include "gameloop.h"
+#include "hostsim.h"
+#include "logger.h"
+
+#define BENCH_FRAMES 3000
+#define UART_BAUD 115200 // What setup() opens Serial at
+#define UART_FIFO_BYTES 128 // What availableForWrite() reports when empty
+
+void setup();
+void loop();
+
+// Scroll through the menu, launch the first game and play it
+static const sim::ScriptStep script[] = {
+  { 20, SIM_ANALOG_IDLE, SIM_ANALOG_MIN, false }, { 20, SIM_ANALOG_IDLE, SIM_ANALOG_MAX, false },
+  { 4, SIM_ANALOG_IDLE, SIM_ANALOG_IDLE, true }, { 40, SIM_ANALOG_MAX, SIM_ANALOG_IDLE, false },
+  { 4, SIM_ANALOG_MAX, SIM_ANALOG_IDLE, true }, { 40, SIM_ANALOG_MIN, SIM_ANALOG_IDLE, false },
+};
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : BENCH_FRAMES;
+  long baud = argc > 2 ? atol(argv[2]) : UART_BAUD;
+  double byteUs = 10 * 1e6 / baud; // Start, 8 data and stop bits
+
+  sim::reset();
+  sim::muteSerial(true);
+  setup();
+  sim::InputScript input(script, sizeof(script) / sizeof(script[0]), Button_PIN, X_PIN, Y_PIN);
+
+  double fifo = 0; // Bytes still waiting in the TX FIFO
+  double stallUs = 0;
+  unsigned long wallUs = 0;
+  uint32_t bytes = 0;
+  for (int frame = 0; frame < frames; frame++) {
+    input.apply();
+    sim::advanceMs(SIM_STEP_MS);
+    fifo = max(0.0, fifo - SIM_STEP_MS * 1000 / byteUs);
+
+    uint32_t before = sim::serialBytesWritten();
+    unsigned long start = sim::wallMicros();
+    loop();
+    wallUs += sim::wallMicros() - start;
+
+    uint32_t written = sim::serialBytesWritten() - before;
+    bytes += written;
+    fifo += written;
+    if (fifo > UART_FIFO_BYTES) {
+      stallUs += (fifo - UART_FIFO_BYTES) * byteUs;
+      fifo = UART_FIFO_BYTES;
+    }
+  }
+  sim::muteSerial(false);
+
+  double totalUs = wallUs + stallUs;
+  printf("{\"bench\":\"logLevel\",\"level\":%d,\"frames\":%d,\"baud\":%ld,\"serialBytes\":%u,"
+         "\"wallUs\":%lu,\"uartStallUs\":%.0f,\"fps\":%.1f}\n",
+         LOG_LEVEL, frames, baud, bytes, wallUs, stallUs, totalUs > 0 ? frames * 1e6 / totalUs : 0.0);
+  return 0;
+}
@@ -0,0 +1,114 @@
+// The dual-core render handoff on the host: the same frames flushed inline
+// and handed to RenderTask, whose std::thread stands in for the task on
+// the second core. Frames start every BENCH_FRAME_US of wall time, like
+// loop() paced by the display. "us" is the time spent drawing and flushing
+// or submitting, the part the handoff takes off the main core. Afterwards
+// the panel must show the framebuffer in both modes.
+//
+//   render_bench [frames]
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <thread>
+#include "config.h"
+#include "framebuffer.h"
+#include "gameloop.h"
+#include "hostsim.h"
+#include "rendertask.h"
+
+#if !DUAL_CORE_RENDER
+#error "render_bench needs a sketch library built with DUAL_CORE_RENDER=1"
+#endif
+
+#define BENCH_FRAMES 2000
+#define BENCH_FRAME_US 500 // Host frames are shorter; the host pushes faster too
+
+static Adafruit_ST7735 panel(TFT_CS, TFT_DC, TFT_MOSI, TFT_SCLK, TFT_RST);
+static GfxBackend backend(panel);
+static FrameBuffer frameBuffer(backend);
+
+// A band scrolling down the screen, recoloured every frame, plus a small
+// block moving across; about a quarter of the screen changes each frame
+static void drawFrame(int i) {
+  int y = i % FRAMEBUFFER_HEIGHT;
+  frameBuffer.fillRect(0, (y + FRAMEBUFFER_HEIGHT - 2) % FRAMEBUFFER_HEIGHT, FRAMEBUFFER_WIDTH, 2, ST77XX_BLACK);
+  frameBuffer.fillRect(0, y, FRAMEBUFFER_WIDTH, min(30, FRAMEBUFFER_HEIGHT - y), i % 2 ? ST77XX_BLUE : ST77XX_CYAN);
+  frameBuffer.fillRect(i % 117, 100, 11, 8, ST77XX_GREEN);
+}
+
+// Idle until the next frame is due
+static void waitForFrame(unsigned long begin) {
+  while (sim::wallMicros() - begin < BENCH_FRAME_US) std::this_thread::yield();
+}
+
+static int mismatched() {
+  const uint16_t *pixels = frameBuffer.getBuffer();
+  int count = 0;
+  for (int y = 0; y < FRAMEBUFFER_HEIGHT; y++) {
+    for (int x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+      if (panel.panelPixel(x, y) != pixels[y * FRAMEBUFFER_WIDTH + x]) count++;
+    }
+  }
+  return count;
+}
+
+static void start() {
+  sim::reset();
+  panel.initR(INITR_144GREENTAB);
+  frameBuffer.fillScreen(ST77XX_BLACK);
+  frameBuffer.flush();
+  panel.resetPanelStats();
+}
+
+static int benchFlush(int frames) {
+  start();
+  unsigned long elapsed = 0;
+  for (int i = 0; i < frames; i++) {
+    unsigned long begin = sim::wallMicros();
+    drawFrame(i);
+    frameBuffer.flush();
+    elapsed += sim::wallMicros() - begin;
+    sim::advanceMs(SIM_STEP_MS);
+    waitForFrame(begin);
+  }
+
+  int wrong = mismatched();
+  printf("{\"bench\":\"renderFlush\",\"frames\":%d,\"us\":%lu,\"pixels\":%u,\"mismatched\":%d}\n",
+         frames, elapsed, panel.panelStats().pixels, wrong);
+  return wrong;
+}
+
+static int benchHandoff(int frames) {
+  start();
+  RenderTask renderTask;
+  renderTask.begin(backend);
+
+  unsigned long elapsed = 0;
+  for (int i = 0; i < frames; i++) {
+    unsigned long begin = sim::wallMicros();
+    drawFrame(i);
+    renderTask.submit(frameBuffer);
+    elapsed += sim::wallMicros() - begin;
+    sim::advanceMs(SIM_STEP_MS);
+    waitForFrame(begin);
+  }
+
+  // Changes kept back while the task was busy go out with one last frame
+  while (!renderTask.idle()) std::this_thread::yield();
+  renderTask.submit(frameBuffer);
+  while (!renderTask.idle()) std::this_thread::yield();
+
+  RenderStats stats = renderTask.stats();
+  int wrong = mismatched();
+  printf("{\"bench\":\"renderHandoff\",\"frames\":%d,\"us\":%lu,\"pixels\":%u,\"submitted\":%u,\"skipped\":%u,\"mismatched\":%d}\n",
+         frames, elapsed, panel.panelStats().pixels, stats.submitted, stats.skipped, wrong);
+  return wrong;
+}
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : BENCH_FRAMES;
+
+  int wrong = benchFlush(frames);
+  wrong += benchHandoff(frames);
+  return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+// Snake played by its autopilot (SNAKE_AUTOPILOT=1) on arenas of growing
+// size, through GameHarness so every frame includes drawChanges() and,
+// once the arena outgrows the screen, the viewport scroll. Prints one
+// profiler line per size; the frame time should not grow with the arena,
+// and the pixel counts show what scrolling costs on the bus.
+//
+//   snake_bench [frames]
+
+#include <Arduino.h>
+#include "gameharness.h"
+#include "snakegame.h"
+
+#if !SNAKE_AUTOPILOT
+#error "snake_bench needs a sketch library built with SNAKE_AUTOPILOT=1"
+#endif
+
+#define BENCH_FRAMES 3000
+#define BENCH_FRAME_MS 17
+
+// Hands off; the autopilot steers and starts every game
+static const sim::ScriptStep script[] = {
+  { 1, SIM_ANALOG_IDLE, SIM_ANALOG_IDLE, false },
+};
+
+template <int GridSize>
+static bool benchSnake(GameHarness &harness, const char *label, int frames) {
+  static BasicSnakeGame<GridSize> game(harness.display(), harness.input());
+  return harness.run(label, game, script, 1, frames, BENCH_FRAME_MS);
+}
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : BENCH_FRAMES;
+
+  static GameHarness harness;
+  bool ok = benchSnake<12>(harness, "snake12", frames);
+  ok &= benchSnake<16>(harness, "snake16", frames);
+  ok &= benchSnake<64>(harness, "snake64", frames);
+  return ok ? 0 : 1;
+}
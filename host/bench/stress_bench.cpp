@@ -0,0 +1,33 @@
+// Space Invaders built with INVADERS_STRESS=1: every wave is the full 6x11
+// formation stepping every 40 ms with all 16 alien bullets in play. Prints
+// the profiler line for the run; the frame times (us) are host wall-clock,
+// the pixel and byte counts are exact.
+//
+//   stress_bench [frames]
+
+#include <Arduino.h>
+#include "gameharness.h"
+#include "spaceinvador.h"
+
+#if !INVADERS_STRESS
+#error "stress_bench needs a sketch library built with INVADERS_STRESS=1"
+#endif
+
+#define BENCH_FRAMES 3000
+#define BENCH_FRAME_MS 17
+
+// Start, then strafe both ways firing
+static const sim::ScriptStep script[] = {
+  { 3, SIM_ANALOG_IDLE, SIM_ANALOG_IDLE, true }, { 30, SIM_ANALOG_MAX, SIM_ANALOG_IDLE, false },
+  { 3, SIM_ANALOG_MAX, SIM_ANALOG_IDLE, true }, { 30, SIM_ANALOG_MIN, SIM_ANALOG_IDLE, false },
+};
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : BENCH_FRAMES;
+
+  static GameHarness harness;
+  static SpaceInvador game(harness.display(), harness.input());
+  bool ok = harness.run("Invaders stress", game, script, sizeof(script) / sizeof(script[0]),
+                        frames, BENCH_FRAME_MS);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+// Blocking against queued flushes on a bus that takes time: every game in
+// GAME_REGISTRY played through WireBackend in both modes. The profiler
+// lines carry the stallUs each mode held the loop for; the last line of
+// each game sums them up. Both runs see the same frames, so the pixel
+// and window counts match and only the stall differs.
+//
+//   wire_bench [frames]
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "gameharness.h"
+#include "gameregistry.h"
+#include "wirebackend.h"
+
+#define BENCH_FRAMES 3000
+#define BENCH_FRAME_MS 17
+
+// Press now and then while sweeping the joystick; plays every game
+static const sim::ScriptStep script[] = {
+  { 3, SIM_ANALOG_IDLE, SIM_ANALOG_IDLE, true }, { 40, SIM_ANALOG_MAX, SIM_ANALOG_IDLE, false },
+  { 3, SIM_ANALOG_MAX, SIM_ANALOG_MIN, true }, { 40, SIM_ANALOG_MIN, SIM_ANALOG_MAX, false },
+};
+
+// Play one game on a fresh backend; the total stall it caused
+static bool play(GameHarness &harness, int index, WireBackend::Mode mode, int frames,
+                 uint32_t &stallUs) {
+  char label[48];
+  snprintf(label, sizeof(label), "%s/%s", GAME_REGISTRY[index].name,
+           mode == WireBackend::BLOCKING ? "blocking" : "queued");
+
+  WireBackend wire(harness.device(), mode);
+  DisplayBackend &previous = harness.display().getBackend();
+  harness.display().setBackend(wire);
+
+  Game *game = GAME_REGISTRY[index].create(harness.display(), harness.input());
+  bool ok = harness.run(label, *game, script, sizeof(script) / sizeof(script[0]), frames,
+                        BENCH_FRAME_MS);
+  stallUs = harness.totals().stallUs;
+
+  harness.display().setBackend(previous);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : BENCH_FRAMES;
+
+  static GameHarness harness;
+  bool ok = true;
+  for (int i = 0; i < GAME_COUNT; i++) {
+    uint32_t blocking, queued;
+    ok &= play(harness, i, WireBackend::BLOCKING, frames, blocking);
+    ok &= play(harness, i, WireBackend::QUEUED, frames, queued);
+    printf("{\"bench\":\"wire\",\"game\":\"%s\",\"frames\":%d,\"blockingStallUs\":%u,\"queuedStallUs\":%u}\n",
+           GAME_REGISTRY[i].name, frames, blocking, queued);
+  }
+  return ok ? 0 : 1;
+}
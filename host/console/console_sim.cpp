@@ -0,0 +1,100 @@
+// Runs the whole console, setup() and loop() from the sketch, on the
+// virtual clock. A scripted player picks a game from the menu and plays
+// it; afterwards the panel contents are checked against the framebuffer
+// and optionally saved as a PPM screenshot.
+//
+//   console_sim [game index] [frames] [screenshot.ppm]
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <vector>
+#include "config.h"
+#include "framebuffer.h"
+#include "gameloop.h"
+#include "hostsim.h"
+
+#define SIM_FRAME_MS SIM_STEP_MS
+#define SIM_FRAMES 3000
+
+extern Adafruit_ST7735 tft;
+extern FrameBuffer frameBuffer;
+void setup();
+void loop();
+
+// Sweep the joystick, press now and then; works as play in every game
+static const sim::ScriptStep playScript[] = {
+  { 40, SIM_ANALOG_MAX, SIM_ANALOG_IDLE, false },
+  { 4, SIM_ANALOG_MAX, SIM_ANALOG_IDLE, true },
+  { 40, SIM_ANALOG_MIN, SIM_ANALOG_IDLE, false },
+  { 4, SIM_ANALOG_MIN, SIM_ANALOG_IDLE, true },
+  { 20, SIM_ANALOG_IDLE, SIM_ANALOG_MIN, false },
+  { 20, SIM_ANALOG_IDLE, SIM_ANALOG_MAX, false },
+};
+
+static bool writeScreenshot(const char *path) {
+  FILE *file = fopen(path, "wb");
+  if (!file) return false;
+  fprintf(file, "P6\n%d %d\n255\n", FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
+  for (int y = 0; y < FRAMEBUFFER_HEIGHT; y++) {
+    for (int x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+      uint16_t c = tft.panelPixel(x, y);
+      uint8_t rgb[3] = { (uint8_t)((c >> 11) << 3), (uint8_t)(((c >> 5) & 0x3F) << 2), (uint8_t)((c & 0x1F) << 3) };
+      fwrite(rgb, 1, 3, file);
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int game = argc > 1 ? atoi(argv[1]) : 0;
+  int frames = argc > 2 ? atoi(argv[2]) : SIM_FRAMES;
+
+  // Menu: wait, step down to the game, press to launch
+  std::vector<sim::ScriptStep> menu;
+  menu.push_back({ 30, SIM_ANALOG_IDLE, SIM_ANALOG_IDLE, false });
+  for (int i = 0; i < game; i++) {
+    menu.push_back({ 4, SIM_ANALOG_IDLE, SIM_ANALOG_MIN, false });
+    menu.push_back({ 16, SIM_ANALOG_IDLE, SIM_ANALOG_IDLE, false });
+  }
+  menu.push_back({ 4, SIM_ANALOG_IDLE, SIM_ANALOG_IDLE, true });
+  menu.push_back({ 30, SIM_ANALOG_IDLE, SIM_ANALOG_IDLE, false });
+  int menuFrames = 0;
+  for (const sim::ScriptStep &step : menu) menuFrames += step.frames;
+
+  sim::InputScript menuInput(menu.data(), menu.size(), Button_PIN, X_PIN, Y_PIN);
+  sim::InputScript playInput(playScript, sizeof(playScript) / sizeof(playScript[0]), Button_PIN, X_PIN, Y_PIN);
+
+  sim::reset();
+  setup();
+  tft.resetPanelStats();
+
+  for (int frame = 0; frame < frames; frame++) {
+    if (frame < menuFrames) {
+      menuInput.apply();
+    } else {
+      playInput.apply();
+    }
+    sim::advanceMs(SIM_FRAME_MS);
+    loop();
+  }
+
+  // Every flush has completed, so the panel must show the framebuffer
+  const uint16_t *pixels = frameBuffer.getBuffer();
+  int mismatched = 0;
+  for (int y = 0; y < FRAMEBUFFER_HEIGHT; y++) {
+    for (int x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+      if (tft.panelPixel(x, y) != pixels[y * FRAMEBUFFER_WIDTH + x]) mismatched++;
+    }
+  }
+
+  const PanelStats &stats = tft.panelStats();
+  printf("{\"console\":%d,\"frames\":%d,\"transactions\":%u,\"windows\":%u,\"pixels\":%u,\"bytes\":%u,\"mismatched\":%d}\n",
+         game, frames, stats.transactions, stats.windows, stats.pixels, stats.bytes, mismatched);
+
+  if (argc > 3 && !writeScreenshot(argv[3])) {
+    fprintf(stderr, "cannot write %s\n", argv[3]);
+    return 1;
+  }
+  return mismatched == 0 ? 0 : 1;
+}
@@ -0,0 +1,4 @@
+// The sketch itself, compiled unchanged; the Arduino IDE would add the
+// Arduino.h include and prototypes, none of which it needs
+#include <Arduino.h>
+#include "ESP32_Game.ino"
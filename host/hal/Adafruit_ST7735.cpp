@@ -0,0 +1,139 @@
+#include "Adafruit_ST7735.h"
+
+// Panel RAM of the ST7735: 132x162, enough for every tab variant
+#define PANEL_RAM_WIDTH 132
+#define PANEL_RAM_HEIGHT 162
+
+SPIClass SPI;
+
+Adafruit_SPITFT::Adafruit_SPITFT(uint16_t w, uint16_t h) :
+  Adafruit_GFX(w, h), windowX(0), windowY(0), windowW(0), windowH(0), cursor(0) {
+  ram = (uint16_t *)calloc(PANEL_RAM_WIDTH * PANEL_RAM_HEIGHT, sizeof(uint16_t));
+  resetPanelStats();
+}
+
+Adafruit_SPITFT::~Adafruit_SPITFT() {
+  free(ram);
+}
+
+void Adafruit_SPITFT::startWrite() {
+  stats.transactions++;
+}
+
+void Adafruit_SPITFT::endWrite() {}
+
+void Adafruit_SPITFT::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  windowX = x;
+  windowY = y;
+  windowW = w;
+  windowH = h;
+  cursor = 0;
+  stats.windows++;
+  stats.bytes += ST77XX_WINDOW_BYTES;
+}
+
+void Adafruit_SPITFT::writeNext(uint16_t color) {
+  if (windowW == 0 || windowH == 0) return;
+  // The controller wraps to the window's next row, then back to its top
+  uint32_t offset = cursor % ((uint32_t)windowW * windowH);
+  uint16_t x = windowX + offset % windowW;
+  uint16_t y = windowY + offset / windowW;
+  if (x < PANEL_RAM_WIDTH && y < PANEL_RAM_HEIGHT) {
+    ram[y * PANEL_RAM_WIDTH + x] = color;
+  }
+  cursor++;
+}
+
+void Adafruit_SPITFT::writePixels(uint16_t *colors, uint32_t len, bool block, bool bigEndian) {
+  (void)block;
+  for (uint32_t i = 0; i < len; i++) {
+    uint16_t color = bigEndian ? (uint16_t)((colors[i] >> 8) | (colors[i] << 8)) : colors[i];
+    writeNext(color);
+  }
+  stats.pixels += len;
+  stats.bytes += len * 2;
+}
+
+void Adafruit_SPITFT::writeColor(uint16_t color, uint32_t len) {
+  for (uint32_t i = 0; i < len; i++) {
+    writeNext(color);
+  }
+  stats.pixels += len;
+  stats.bytes += len * 2;
+}
+
+bool Adafruit_SPITFT::clip(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const {
+  if (w < 0) { x += w + 1; w = -w; }
+  if (h < 0) { y += h + 1; h = -h; }
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > _width) w = _width - x;
+  if (y + h > _height) h = _height - y;
+  return w > 0 && h > 0;
+}
+
+void Adafruit_SPITFT::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+  startWrite();
+  writePixel(x, y, color);
+  endWrite();
+}
+
+void Adafruit_SPITFT::writePixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+  setAddrWindow(x, y, 1, 1);
+  writeColor(color, 1);
+}
+
+void Adafruit_SPITFT::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (!clip(x, y, w, h)) return;
+  setAddrWindow(x, y, w, h);
+  writeColor(color, (uint32_t)w * h);
+}
+
+void Adafruit_SPITFT::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  writeFillRect(x, y, 1, h, color);
+}
+
+void Adafruit_SPITFT::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  writeFillRect(x, y, w, 1, color);
+}
+
+void Adafruit_SPITFT::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (!clip(x, y, w, h)) return;
+  startWrite();
+  writeFillRect(x, y, w, h, color);
+  endWrite();
+}
+
+void Adafruit_SPITFT::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void Adafruit_SPITFT::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+uint16_t Adafruit_SPITFT::panelPixel(int16_t x, int16_t y) const {
+  if (x < 0 || y < 0 || x >= PANEL_RAM_WIDTH || y >= PANEL_RAM_HEIGHT) return 0;
+  return ram[y * PANEL_RAM_WIDTH + x];
+}
+
+void Adafruit_SPITFT::resetPanelStats() {
+  memset(&stats, 0, sizeof(stats));
+}
+
+Adafruit_ST7735::Adafruit_ST7735(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst) :
+  Adafruit_SPITFT(128, 160) {
+  (void)cs; (void)dc; (void)mosi; (void)sclk; (void)rst;
+}
+
+Adafruit_ST7735::Adafruit_ST7735(int8_t cs, int8_t dc, int8_t rst) : Adafruit_SPITFT(128, 160) {
+  (void)cs; (void)dc; (void)rst;
+}
+
+void Adafruit_ST7735::initR(uint8_t options) {
+  // The 1.44" green tab is square, the others 128x160
+  HEIGHT = options == INITR_144GREENTAB ? 128 : 160;
+  setRotation(0);
+}
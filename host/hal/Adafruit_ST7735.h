@@ -0,0 +1,92 @@
+#ifndef ADAFRUIT_ST7735_H
+#define ADAFRUIT_ST7735_H
+
+#include <Adafruit_GFX.h>
+#include <SPI.h>
+
+#define INITR_GREENTAB 0x00
+#define INITR_REDTAB 0x01
+#define INITR_BLACKTAB 0x02
+#define INITR_144GREENTAB 0x01
+
+#define ST77XX_BLACK 0x0000
+#define ST77XX_WHITE 0xFFFF
+#define ST77XX_RED 0xF800
+#define ST77XX_GREEN 0x07E0
+#define ST77XX_BLUE 0x001F
+#define ST77XX_CYAN 0x07FF
+#define ST77XX_MAGENTA 0xF81F
+#define ST77XX_YELLOW 0xFFE0
+#define ST77XX_ORANGE 0xFC00
+
+#define ST7735_BLACK ST77XX_BLACK
+#define ST7735_WHITE ST77XX_WHITE
+#define ST7735_RED ST77XX_RED
+#define ST7735_GREEN ST77XX_GREEN
+#define ST7735_BLUE ST77XX_BLUE
+#define ST7735_CYAN ST77XX_CYAN
+#define ST7735_MAGENTA ST77XX_MAGENTA
+#define ST7735_YELLOW ST77XX_YELLOW
+#define ST7735_ORANGE ST77XX_ORANGE
+
+// Bytes on the wire for one address window: CASET and RASET with four
+// parameter bytes each, then RAMWR
+#define ST77XX_WINDOW_BYTES 11
+
+// What reached the panel since the last resetPanelStats()
+struct PanelStats {
+  uint32_t transactions; // startWrite()/endWrite() pairs
+  uint32_t windows;      // Address windows set
+  uint32_t pixels;       // Pixels written into panel RAM
+  uint32_t bytes;        // Bytes clocked out, commands and pixels
+};
+
+// Stand-in for the SPI display driver. Instead of clocking bytes out it
+// writes them into a copy of the panel RAM and counts them, so tests can
+// compare what a flush left on screen with the framebuffer. Panel RAM is
+// addressed in screen coordinates; the controller's row/column offsets
+// and rotation mapping are not modelled.
+class Adafruit_SPITFT : public Adafruit_GFX {
+public:
+  Adafruit_SPITFT(uint16_t w, uint16_t h);
+  ~Adafruit_SPITFT();
+
+  void startWrite() override;
+  void endWrite() override;
+  virtual void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  void writePixels(uint16_t *colors, uint32_t len, bool block = true, bool bigEndian = false);
+  void writeColor(uint16_t color, uint32_t len);
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void writePixel(int16_t x, int16_t y, uint16_t color) override;
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+
+  // Host only
+  uint16_t panelPixel(int16_t x, int16_t y) const;
+  const PanelStats &panelStats() const { return stats; }
+  void resetPanelStats();
+
+private:
+  bool clip(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const;
+  void writeNext(uint16_t color);
+
+  uint16_t *ram;
+  uint16_t windowX, windowY, windowW, windowH;
+  uint32_t cursor;
+  PanelStats stats;
+};
+
+class Adafruit_ST7735 : public Adafruit_SPITFT {
+public:
+  Adafruit_ST7735(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst = -1);
+  Adafruit_ST7735(int8_t cs, int8_t dc, int8_t rst);
+
+  void initR(uint8_t options = INITR_GREENTAB);
+};
+
+#endif
@@ -0,0 +1,240 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include "hostsim.h"
+
+#define SIM_EEPROM_SIZE 4096
+
+// Atomic so threads of the host build (the render task) can read it
+static std::atomic<uint64_t> clockUs(0);
+static uint8_t digitalLevels[SIM_PIN_COUNT];
+static uint16_t analogLevels[SIM_PIN_COUNT];
+static void (*isrs[SIM_PIN_COUNT])();
+static int isrModes[SIM_PIN_COUNT];
+static uint32_t randomState = 1;
+static uint8_t eepromData[SIM_EEPROM_SIZE];
+static int commits = 0;
+static uint32_t serialBytes = 0;
+static bool serialMuted = false;
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+
+unsigned long millis() {
+  return (unsigned long)(uint32_t)(clockUs.load() / 1000);
+}
+
+unsigned long micros() {
+  // 32 bits wide like the ESP32's, so wrap-around behaves the same
+  return (unsigned long)(uint32_t)clockUs.load();
+}
+
+void delay(uint32_t ms) {
+  clockUs += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(uint32_t us) {
+  clockUs += us;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  if (pin < SIM_PIN_COUNT) digitalLevels[pin] = level ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < SIM_PIN_COUNT ? digitalLevels[pin] : LOW;
+}
+
+uint16_t analogRead(uint8_t pin) {
+  return pin < SIM_PIN_COUNT ? analogLevels[pin] : 0;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+  if (pin >= SIM_PIN_COUNT) return;
+  isrs[pin] = isr;
+  isrModes[pin] = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < SIM_PIN_COUNT) isrs[pin] = nullptr;
+}
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  // xorshift32: cheap, and the same sequence on every host
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+  randomState = seed ? (uint32_t)seed : 1;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::print(long value, int base) {
+  if (base == DEC) return print((long long)value, base);
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  return print((unsigned long long)value, base);
+}
+
+size_t Print::print(long long value, int base) {
+  if (value < 0 && base == DEC) {
+    size_t n = print('-');
+    return n + print((unsigned long long)-value, base);
+  }
+  return print((unsigned long long)value, base);
+}
+
+size_t Print::print(unsigned long long value, int base) {
+  char digits[65];
+  char *p = &digits[sizeof(digits) - 1];
+  *p = '\0';
+  if (base < 2) base = DEC;
+  do {
+    int digit = value % base;
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while (value);
+  return write(p);
+}
+
+size_t Print::print(double value, int digits) {
+  char text[48];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  serialBytes += size;
+  return serialMuted ? size : fwrite(buffer, 1, size, stdout);
+}
+
+int HardwareSerial::availableForWrite() {
+  return 128; // Room in an empty UART TX FIFO
+}
+
+bool EEPROMClass::begin(size_t size) {
+  this->size = min(size, (size_t)SIM_EEPROM_SIZE);
+  return true;
+}
+
+uint8_t EEPROMClass::read(int address) {
+  return address >= 0 && address < SIM_EEPROM_SIZE ? eepromData[address] : 0;
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+  if (address >= 0 && address < SIM_EEPROM_SIZE) eepromData[address] = value;
+}
+
+bool EEPROMClass::commit() {
+  commits++;
+  return true;
+}
+
+namespace sim {
+
+void reset() {
+  clockUs = 0;
+  for (int i = 0; i < SIM_PIN_COUNT; i++) {
+    digitalLevels[i] = LOW;
+    analogLevels[i] = SIM_ANALOG_IDLE;
+    isrs[i] = nullptr;
+    isrModes[i] = 0;
+  }
+  // ESP32 EEPROM emulation starts out zeroed, not 0xFF like raw flash
+  memset(eepromData, 0, sizeof(eepromData));
+  commits = 0;
+  serialBytes = 0;
+  serialMuted = false;
+  randomSeed(1);
+}
+
+uint32_t serialBytesWritten() {
+  return serialBytes;
+}
+
+void muteSerial(bool muted) {
+  serialMuted = muted;
+}
+
+void advanceUs(uint32_t us) {
+  clockUs += us;
+}
+
+void advanceMs(uint32_t ms) {
+  clockUs += (uint64_t)ms * 1000;
+}
+
+void setAnalog(uint8_t pin, uint16_t value) {
+  if (pin < SIM_PIN_COUNT) analogLevels[pin] = value;
+}
+
+void setDigital(uint8_t pin, uint8_t level) {
+  if (pin >= SIM_PIN_COUNT) return;
+  uint8_t old = digitalLevels[pin];
+  digitalLevels[pin] = level ? HIGH : LOW;
+  if (old == digitalLevels[pin] || !isrs[pin]) return;
+
+  int edge = digitalLevels[pin] == HIGH ? RISING : FALLING;
+  if (isrModes[pin] & edge) isrs[pin]();
+}
+
+int pinLevel(uint8_t pin) {
+  return digitalRead(pin);
+}
+
+uint8_t *eeprom() {
+  return eepromData;
+}
+
+int eepromCommits() {
+  return commits;
+}
+
+unsigned long wallMicros() {
+  using namespace std::chrono;
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+InputScript::InputScript(const ScriptStep *steps, int count, uint8_t buttonPin, uint8_t xPin, uint8_t yPin) :
+  steps(steps), count(count), buttonPin(buttonPin), xPin(xPin), yPin(yPin), step(0), frame(0) {}
+
+void InputScript::apply() {
+  const ScriptStep &s = steps[step];
+  setAnalog(xPin, s.x);
+  setAnalog(yPin, s.y);
+  setDigital(buttonPin, s.button ? HIGH : LOW);
+
+  if (++frame >= s.frames) {
+    frame = 0;
+    step = (step + 1) % count;
+  }
+}
+
+} // namespace sim
@@ -0,0 +1,21 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <Arduino.h>
+
+// In-memory EEPROM; sim::reset() erases it, sim::eeprom() exposes it
+class EEPROMClass {
+public:
+  bool begin(size_t size);
+  uint8_t read(int address);
+  void write(int address, uint8_t value);
+  bool commit();
+  size_t length() const { return size; }
+
+private:
+  size_t size = 0;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
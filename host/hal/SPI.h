@@ -0,0 +1,30 @@
+#ifndef SPI_H
+#define SPI_H
+
+#include <Arduino.h>
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+struct SPISettings {
+  SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0) :
+    clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+
+  uint32_t clock;
+  uint8_t bitOrder;
+  uint8_t dataMode;
+};
+
+// Bus traffic is counted by the display stand-in in Adafruit_ST7735.h
+class SPIClass {
+public:
+  void begin() {}
+  void beginTransaction(const SPISettings &settings) { this->settings = settings; }
+  void endTransaction() {}
+
+  SPISettings settings;
+};
+
+extern SPIClass SPI;
+
+#endif
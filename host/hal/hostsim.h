@@ -0,0 +1,71 @@
+#ifndef HOSTSIM_H
+#define HOSTSIM_H
+
+#include <Arduino.h>
+
+// Controls for the host HAL: the virtual clock behind millis()/micros(),
+// the levels the sketch reads from its pins, and the EEPROM contents.
+namespace sim {
+
+#define SIM_PIN_COUNT 32
+#define SIM_ANALOG_MIN 0
+#define SIM_ANALOG_IDLE 1650 // Centred joystick, inside the deadzone
+#define SIM_ANALOG_MAX 4095
+
+// Back to power-on: clock at 0, pins idle, ISRs detached, EEPROM erased,
+// Serial counters cleared and random() reseeded
+void reset();
+
+void advanceUs(uint32_t us);
+void advanceMs(uint32_t ms);
+
+void setAnalog(uint8_t pin, uint16_t value);
+
+// Drive an input pin; runs its ISR on a matching edge, as the GPIO
+// interrupt would between two instructions of the sketch
+void setDigital(uint8_t pin, uint8_t level);
+
+// Last level written to or driven onto a pin
+int pinLevel(uint8_t pin);
+
+// Bytes the sketch has written to Serial since reset()
+uint32_t serialBytesWritten();
+
+// Keep counting Serial output but stop printing it
+void muteSerial(bool muted);
+
+uint8_t *eeprom();
+int eepromCommits();
+
+// Real elapsed time in µs, for timing host code; the virtual clock only
+// moves when told to
+unsigned long wallMicros();
+
+// One stretch of a scripted input: the joystick held at (x, y) and the
+// button at `button` for `frames` frames
+struct ScriptStep {
+  uint16_t frames;
+  uint16_t x, y;
+  bool button;
+};
+
+// Replays a list of steps onto the input pins, looping at the end, so
+// two runs of the same script see exactly the same input
+class InputScript {
+public:
+  InputScript(const ScriptStep *steps, int count, uint8_t buttonPin, uint8_t xPin, uint8_t yPin);
+
+  // Set the pins for the next frame
+  void apply();
+
+private:
+  const ScriptStep *steps;
+  int count;
+  uint8_t buttonPin, xPin, yPin;
+  int step;
+  uint16_t frame;
+};
+
+} // namespace sim
+
+#endif
@@ -0,0 +1,70 @@
+#include "gameharness.h"
+#include <stdio.h>
+#include "config.h"
+#include "frameprofiler.h"
+#include "scheduler.h"
+
+GameHarness::GameHarness() :
+  panel(TFT_CS, TFT_DC, TFT_MOSI, TFT_SCLK, TFT_RST), backend(panel), frameBuffer(backend),
+  inputHandler(Button_PIN, X_PIN, Y_PIN) {}
+
+bool GameHarness::run(const char *label, Game &game, const sim::ScriptStep *steps, int stepCount,
+                      int frames, unsigned long frameMs, unsigned long stepMs) {
+  sim::reset();
+  panel.initR(INITR_144GREENTAB);
+  frameBuffer.getBackend().begin();
+  inputHandler.begin();
+  frameBuffer.fillScreen(0);
+  frameBuffer.flush();
+
+  FixedStepLoop loop(stepMs, MAX_CATCH_UP_STEPS);
+  FrameProfiler profiler(frameBuffer, loop.stats(), Serial, sim::wallMicros);
+  sim::InputScript script(steps, stepCount, Button_PIN, X_PIN, Y_PIN);
+
+  game.init();
+  inputHandler.reset();
+  loop.reset(millis());
+  panel.resetPanelStats();
+
+  runTotals = FlushStats();
+  for (int frame = 0; frame < frames; frame++) {
+    script.apply();
+    sim::advanceMs(frameMs);
+
+    profiler.beginFrame();
+    scheduler.run();
+    int count = loop.advance(millis());
+    for (int i = 0; i < count; i++) {
+      inputHandler.update();
+      game.update(stepMs, inputHandler);
+    }
+    game.render(loop.alpha());
+    frameBuffer.flush();
+
+    const FlushStats &stats = frameBuffer.stats();
+    runTotals.drawCalls += stats.drawCalls;
+    runTotals.windowsOpened += stats.windowsOpened;
+    runTotals.pixelsPushed += stats.pixelsPushed;
+    runTotals.stallUs += stats.stallUs;
+    profiler.endFrame(label);
+  }
+  profiler.flush();
+
+  bool ok = true;
+  const PanelStats &stats = panel.panelStats();
+  uint32_t bytes = runTotals.pixelsPushed * 2 + runTotals.windowsOpened * ADDR_WINDOW_BYTES;
+  if (stats.bytes != bytes) {
+    fprintf(stderr, "%s: panel got %u bytes, flush stats account for %u\n", label, stats.bytes, bytes);
+    ok = false;
+  }
+  const uint16_t *buffer = frameBuffer.getBuffer();
+  for (int y = 0; y < FRAMEBUFFER_HEIGHT; y++) {
+    for (int x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+      if (panel.panelPixel(x, y) != buffer[y * FRAMEBUFFER_WIDTH + x]) {
+        fprintf(stderr, "%s: panel differs from the framebuffer at %d,%d\n", label, x, y);
+        return false;
+      }
+    }
+  }
+  return ok;
+}
@@ -0,0 +1,44 @@
+#ifndef GAMEHARNESS_H
+#define GAMEHARNESS_H
+
+#include <Arduino.h>
+#include "framebuffer.h"
+#include "game.h"
+#include "gameloop.h"
+#include "hostsim.h"
+#include "inputhandler.h"
+
+// Plays a game the way the console's loop() does: scripted input, due
+// timers, fixed simulation steps, render and flush, on the virtual clock.
+// Each frame is timed on the wall clock and profiled, so a run prints one
+// FrameProfiler line per PROFILE_WINDOW frames. Pixel, window and byte
+// counts only depend on the script, so two runs can be diffed.
+class GameHarness {
+public:
+  GameHarness();
+
+  FrameBuffer &display() { return frameBuffer; }
+  InputHandler &input() { return inputHandler; }
+
+  // The simulated panel, for a backend to push to instead of the default
+  // one; install it with display().setBackend()
+  Adafruit_ST7735 &device() { return panel; }
+
+  // Play `frames` frames of `game` from a fresh console, frameMs of
+  // virtual time apart. False when the panel doesn't show the framebuffer
+  // afterwards or its byte count disagrees with the flush stats.
+  bool run(const char *label, Game &game, const sim::ScriptStep *steps, int stepCount,
+           int frames, unsigned long frameMs, unsigned long stepMs = SIM_STEP_MS);
+
+  // Flush costs summed over the frames of the last run()
+  const FlushStats &totals() const { return runTotals; }
+
+private:
+  Adafruit_ST7735 panel;
+  GfxBackend backend;
+  FrameBuffer frameBuffer;
+  InputHandler inputHandler;
+  FlushStats runTotals;
+};
+
+#endif
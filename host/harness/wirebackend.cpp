@@ -0,0 +1,59 @@
+#include "wirebackend.h"
+#include "hostsim.h"
+
+WireBackend::WireBackend(Adafruit_SPITFT &display, Mode mode) :
+  panel(display), mode(mode), idleAt(micros()) {}
+
+bool WireBackend::begin() {
+  idleAt = micros();
+  return true;
+}
+
+uint32_t WireBackend::wireUs(uint32_t bytes) {
+  return (uint32_t)((uint64_t)bytes * 8 * 1000000 / WIRE_SPI_HZ);
+}
+
+void WireBackend::stall(uint32_t us, FlushStats &stats) {
+  sim::advanceUs(us);
+  stats.stallUs += us;
+}
+
+void WireBackend::sendWindow(int16_t w, int16_t h, FlushStats &stats) {
+  uint32_t pixelCount = (uint32_t)w * h;
+  if (mode == BLOCKING) {
+    stall(wireUs(ADDR_WINDOW_BYTES + pixelCount * 2), stats);
+    return;
+  }
+
+  // Window commands are polled, which needs the queue drained first
+  long busy = (long)(idleAt - micros());
+  if (busy > 0) stall(busy, stats);
+  stall(wireUs(ADDR_WINDOW_BYTES), stats);
+
+  // The pool takes the tail of the data; the rest waits for buffers
+  uint32_t queued = min(pixelCount, (uint32_t)WIRE_QUEUE_PIXELS);
+  stall(wireUs((pixelCount - queued) * 2), stats);
+  idleAt = micros() + wireUs(queued * 2);
+}
+
+void WireBackend::push(const uint16_t *pixels, const DirtyRegion &region, FlushStats &stats) {
+  // Deliver first; the panel has no notion of time
+  FlushStats sent = {0, 0, 0, 0};
+  panel.push(pixels, region, sent);
+  stats.windowsOpened += sent.windowsOpened;
+  stats.pixelsPushed += sent.pixelsPushed;
+
+  for (int i = 0; i < region.count(); i++) {
+    const DirtyRect &r = region.rect(i);
+    sendWindow(r.w, r.h, stats);
+  }
+  DirtyRect span = {0, 0, 0, 1};
+  while (region.nextSpan(span)) {
+    sendWindow(span.w, span.h, stats);
+  }
+}
+
+void WireBackend::wait() {
+  long busy = (long)(idleAt - micros());
+  if (busy > 0) sim::advanceUs(busy);
+}
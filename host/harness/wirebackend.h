@@ -0,0 +1,42 @@
+#ifndef WIREBACKEND_H
+#define WIREBACKEND_H
+
+#include <Arduino.h>
+#include "displaybackend.h"
+
+#define WIRE_SPI_HZ 40000000 // What DmaBackend clocks the bus at
+#define WIRE_QUEUE_PIXELS (2 * FRAMEBUFFER_WIDTH * 16) // DmaBackend's line pool
+
+// Host stand-in for the display bus that costs virtual time. Pixels reach
+// the panel through a GfxBackend at once, but the virtual clock is charged
+// what the bytes would take on the wire at WIRE_SPI_HZ:
+//  - BLOCKING holds the caller for every byte, like GfxBackend on the device
+//  - QUEUED works like DmaBackend: window commands wait for the bus to go
+//    idle, pixel data is queued up to WIRE_QUEUE_PIXELS and sends while
+//    the caller carries on; only data past that blocks
+// Time the caller is held goes into FlushStats::stallUs, so the two modes
+// can be compared on the same frames.
+class WireBackend : public DisplayBackend {
+public:
+  enum Mode { BLOCKING, QUEUED };
+
+  WireBackend(Adafruit_SPITFT &display, Mode mode);
+
+  // Start with an idle bus at the current virtual time
+  bool begin() override;
+  void push(const uint16_t *pixels, const DirtyRegion &region, FlushStats &stats) override;
+  void wait() override;
+
+private:
+  // Hold the caller for us of virtual time
+  static void stall(uint32_t us, FlushStats &stats);
+  static uint32_t wireUs(uint32_t bytes);
+
+  void sendWindow(int16_t w, int16_t h, FlushStats &stats);
+
+  GfxBackend panel;
+  Mode mode;
+  unsigned long idleAt; // micros() the queued data is all sent by
+};
+
+#endif
@@ -0,0 +1,150 @@
+// EventQueue: FIFO order across index wrap-around, drops on a full queue,
+// a producer thread racing the consumer, and button edges fed through the
+// InputHandler ISR by the pin simulator
+
+#include <Arduino.h>
+#include <thread>
+#include "check.h"
+#include "config.h"
+#include "eventqueue.h"
+#include "hostsim.h"
+#include "inputhandler.h"
+
+static void wrapAround() {
+  EventQueue<uint32_t, 8> queue;
+  uint32_t next = 0, expected = 0, item;
+
+  // Uneven batches walk head and tail past the end many times over
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < 1 + round % 7; i++) {
+      CHECK(queue.push(next++));
+    }
+    while (queue.pop(item)) {
+      CHECK(item == expected);
+      expected++;
+    }
+    CHECK(queue.empty());
+  }
+  CHECK(expected == next);
+  CHECK(queue.dropped() == 0);
+}
+
+static void fullQueueDrops() {
+  EventQueue<uint32_t, 8> queue;
+  uint32_t item;
+
+  // One slot stays free to tell full from empty
+  for (uint32_t i = 0; i < 7; i++) {
+    CHECK(queue.push(i));
+  }
+  CHECK(!queue.push(7));
+  CHECK(!queue.push(8));
+  CHECK(queue.dropped() == 2);
+
+  // The queued items are intact and in order; the dropped ones are gone
+  for (uint32_t i = 0; i < 7; i++) {
+    CHECK(queue.pop(item));
+    CHECK(item == i);
+  }
+  CHECK(!queue.pop(item));
+
+  CHECK(queue.push(9));
+  CHECK(queue.pop(item));
+  CHECK(item == 9);
+}
+
+static void producerConsumer() {
+  const uint32_t count = 1000000;
+  EventQueue<uint32_t, 16> queue;
+  uint32_t pushed = 0;
+
+  // Like the ISR, the producer never waits: a push into a full queue is lost
+  std::thread producer([&]() {
+    for (uint32_t i = 1; i <= count; i++) {
+      if (queue.push(i)) pushed++;
+    }
+  });
+
+  uint32_t popped = 0, last = 0, item;
+  bool ordered = true;
+  while (true) {
+    bool done = popped + queue.dropped() == count;
+    if (queue.pop(item)) {
+      ordered &= item > last;
+      last = item;
+      popped++;
+    } else if (done) {
+      break;
+    }
+  }
+  producer.join();
+
+  CHECK(ordered);
+  CHECK(popped == pushed);
+  CHECK(popped + queue.dropped() == count);
+}
+
+// Drive the button pin afterUs µs after the previous step
+static void edge(uint8_t level, uint32_t afterUs) {
+  sim::advanceUs(afterUs);
+  sim::setDigital(Button_PIN, level);
+}
+
+static void isrEdges() {
+  sim::reset();
+  InputHandler input(Button_PIN, X_PIN, Y_PIN);
+  input.begin();
+
+  // A tap shorter than a frame: both edges reach the next update()
+  edge(HIGH, 10000);
+  edge(LOW, 8000);
+  sim::advanceUs(8000);
+  input.update();
+  CHECK(input.eventCount() == 2);
+  CHECK(input.buttonPressed && input.buttonReleased);
+  CHECK(input.event(0).type == ButtonEvent::PRESS);
+  CHECK(input.event(1).type == ButtonEvent::RELEASE);
+
+  // Contact bounce inside the debounce window is one press
+  edge(HIGH, 20000);
+  edge(LOW, 300);
+  edge(HIGH, 300);
+  edge(LOW, 300);
+  edge(HIGH, 300);
+  sim::advanceUs(10000);
+  input.update();
+  CHECK(input.eventCount() == 1);
+  CHECK(input.buttonPressed && !input.buttonReleased);
+
+  // An ISR firing between two updates with nothing new queues nothing
+  input.update();
+  CHECK(input.eventCount() == 0);
+  CHECK(!input.buttonPressed);
+
+  // More edges than the queue holds between two updates: the overflow is
+  // dropped, and the handler still ends up at the pin's real level
+  for (int i = 0; i < BUTTON_QUEUE_SIZE * 2; i++) {
+    edge(i % 2 ? HIGH : LOW, BUTTON_DEBOUNCE_US);
+  }
+  sim::advanceUs(BUTTON_DEBOUNCE_US);
+  input.update();
+  CHECK(input.eventCount() == BUTTON_QUEUE_SIZE); // Queued edges plus one to catch up
+  CHECK(input.event(input.eventCount() - 1).type == ButtonEvent::PRESS);
+  CHECK(sim::pinLevel(Button_PIN) == HIGH);
+  sim::advanceUs(BUTTON_HOLD_MS * 1000UL + 1000);
+  input.update();
+  CHECK(input.buttonHeld);
+
+  edge(LOW, BUTTON_DEBOUNCE_US);
+  input.update();
+  CHECK(input.buttonReleased);
+  CHECK(!input.buttonHeld);
+}
+
+int main() {
+  wrapAround();
+  fullQueueDrops();
+  producerConsumer();
+  isrEdges();
+  return CHECK_RESULT();
+}
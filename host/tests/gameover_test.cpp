@@ -0,0 +1,70 @@
+// GameOverInput fed by real button edges: a tap restarts on release, a
+// hold asks for the menu, and a button still down from play does neither
+
+#include <Arduino.h>
+#include "check.h"
+#include "config.h"
+#include "game.h"
+#include "hostsim.h"
+#include "inputhandler.h"
+
+static InputHandler input(Button_PIN, X_PIN, Y_PIN);
+
+// Hold the button at `level` for `ms`, updating once per step like the console
+static GameOverInput::Action hold(GameOverInput &screen, uint8_t level, unsigned long ms) {
+  GameOverInput::Action action = GameOverInput::NONE;
+  sim::setDigital(Button_PIN, level);
+  for (unsigned long t = 0; t < ms; t += 10) {
+    sim::advanceMs(10);
+    input.update();
+    GameOverInput::Action now = screen.update(input);
+    if (now != GameOverInput::NONE) {
+      CHECK(action == GameOverInput::NONE); // One action per press
+      action = now;
+    }
+  }
+  return action;
+}
+
+static void start(GameOverInput &screen) {
+  sim::reset();
+  input.begin();
+  input.reset();
+  screen.reset();
+}
+
+static void tapRestarts() {
+  GameOverInput screen;
+  start(screen);
+  CHECK(hold(screen, LOW, 100) == GameOverInput::NONE);
+  CHECK(hold(screen, HIGH, 100) == GameOverInput::NONE);
+  CHECK(hold(screen, LOW, 50) == GameOverInput::RESTART);
+}
+
+static void holdAsksForMenu() {
+  GameOverInput screen;
+  start(screen);
+  CHECK(hold(screen, HIGH, BUTTON_HOLD_MS + 100) == GameOverInput::MENU);
+  // Letting go afterwards doesn't also restart
+  CHECK(hold(screen, LOW, 50) == GameOverInput::NONE);
+}
+
+static void pressFromPlayIgnored() {
+  GameOverInput screen;
+  start(screen);
+  // Pressed during play, game over arrives while it is still down
+  hold(screen, HIGH, 50);
+  screen.reset();
+  CHECK(hold(screen, HIGH, BUTTON_HOLD_MS + 100) == GameOverInput::NONE);
+  CHECK(hold(screen, LOW, 50) == GameOverInput::NONE);
+  // The next press counts
+  CHECK(hold(screen, HIGH, 50) == GameOverInput::NONE);
+  CHECK(hold(screen, LOW, 50) == GameOverInput::RESTART);
+}
+
+int main() {
+  tapRestarts();
+  holdAsksForMenu();
+  pressFromPlayIgnored();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,52 @@
+// InputHandler's X filter: it must settle on the raw reading from either
+// side, so full deflection reaches the end of the axis both ways
+
+#include <Arduino.h>
+#include "check.h"
+#include "config.h"
+#include "hostsim.h"
+#include "inputhandler.h"
+
+static InputHandler input(Button_PIN, X_PIN, Y_PIN);
+
+static void hold(uint16_t x, int samples) {
+  sim::setAnalog(X_PIN, x);
+  for (int i = 0; i < samples; i++) {
+    sim::advanceMs(16);
+    input.update();
+  }
+}
+
+static void settlesBothWays() {
+  sim::reset();
+  input.begin();
+  input.reset();
+
+  hold(SIM_ANALOG_IDLE, 1);
+  CHECK(input.xAxis == 0);
+
+  hold(SIM_ANALOG_MAX, 60);
+  CHECK(input.xAxis == JOYSTICK_AXIS_MAX);
+
+  hold(SIM_ANALOG_MIN, 60);
+  CHECK(input.xAxis == -JOYSTICK_AXIS_MAX);
+
+  // Back to centre ends inside the deadzone, not a few counts outside it
+  hold(SIM_ANALOG_IDLE, 60);
+  CHECK(input.xAxis == 0);
+}
+
+static void firstSampleTakenAsIs() {
+  sim::reset();
+  input.begin();
+  input.reset();
+
+  hold(SIM_ANALOG_MAX, 1);
+  CHECK(input.xAxis == JOYSTICK_AXIS_MAX);
+}
+
+int main() {
+  settlesBothWays();
+  firstSampleTakenAsIs();
+  return CHECK_RESULT();
+}
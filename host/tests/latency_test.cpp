@@ -0,0 +1,95 @@
+// Input latency through the harness while the console is busy with timed
+// effects: a button edge during a vibration pulse or the pause between
+// Space Invaders waves must reach the game on the very next step
+
+#include <Arduino.h>
+#include "check.h"
+#include "config.h"
+#include "gameharness.h"
+#include "spaceinvador.h"
+#include "vibration.h"
+
+#define EFFECT_STEP 40 // Step the effect starts at; the game is playing by then
+#define PRESS_FRAME 45 // Frame whose script presses the button again
+
+#define IDLE SIM_ANALOG_IDLE
+
+// Press to start, let go, then press again a few frames into the effect
+static const sim::ScriptStep script[] = {
+  { 2, IDLE, IDLE, true }, { PRESS_FRAME - 2, IDLE, IDLE, false }, { 5, IDLE, IDLE, true },
+  { 200, IDLE, IDLE, false },
+};
+
+enum Effect { VIBRATION, LEVEL_PAUSE_EFFECT };
+
+// Forwards to Space Invaders, starts the effect at EFFECT_STEP and notes
+// the step the button went down on and the step the game saw the press
+class PressProbe : public Game {
+public:
+  PressProbe(SpaceInvador &game, Effect effect) :
+    game(game), effect(effect), motor(Vibrationmotor_PIN) {}
+
+  void init() override {
+    game.init();
+    step = 0;
+    downStep = seenStep = -1;
+    effectAt = 0;
+    motorOnWhenSeen = runningWhenSeen = false;
+  }
+
+  void update(unsigned long dt, InputHandler &input) override {
+    step++;
+    if (step == EFFECT_STEP) {
+      effectAt = millis();
+      if (effect == VIBRATION) {
+        motor.pulse(500);
+      } else {
+        game.levelComplete();
+      }
+    }
+
+    if (step > EFFECT_STEP) {
+      if (downStep < 0 && sim::pinLevel(Button_PIN) == HIGH) downStep = step;
+      if (seenStep < 0 && input.buttonPressed) {
+        seenStep = step;
+        seenAt = millis();
+        motorOnWhenSeen = sim::pinLevel(Vibrationmotor_PIN) == HIGH;
+        runningWhenSeen = game.isRunning();
+      }
+    }
+    game.update(dt, input);
+  }
+
+  void render(Fixed8 alpha) override { game.render(alpha); }
+  bool wantsMenu() const override { return game.wantsMenu(); }
+
+  SpaceInvador &game;
+  Effect effect;
+  VibrationMotor motor;
+  int step, downStep, seenStep;
+  unsigned long effectAt, seenAt;
+  bool motorOnWhenSeen, runningWhenSeen;
+};
+
+static void pressSeenDuring(const char *label, Effect effect) {
+  GameHarness harness;
+  SpaceInvador invaders(harness.display(), harness.input());
+  PressProbe probe(invaders, effect);
+
+  // One step per frame, so a step is the finest the game can react at
+  CHECK(harness.run(label, probe, script, sizeof(script) / sizeof(script[0]), 120, SIM_STEP_MS));
+  CHECK(probe.downStep > 0);
+  CHECK(probe.seenStep == probe.downStep);
+  CHECK(probe.runningWhenSeen);
+  if (effect == VIBRATION) {
+    CHECK(probe.motorOnWhenSeen);
+  } else {
+    CHECK(probe.seenAt - probe.effectAt < LEVEL_PAUSE);
+  }
+}
+
+int main() {
+  pressSeenDuring("latencyVibration", VIBRATION);
+  pressSeenDuring("latencyLevelPause", LEVEL_PAUSE_EFFECT);
+  return CHECK_RESULT();
+}
@@ -0,0 +1,59 @@
+// Telemetry framing, rate limiting and TX-full drops, sent through a
+// Stream that isn't a HardwareSerial
+
+#include <Arduino.h>
+#include <vector>
+#include "check.h"
+#include "hostsim.h"
+#include "telemetry.h"
+
+// Captures what was written and reports a settable amount of TX room
+class CaptureStream : public Stream {
+public:
+  size_t write(uint8_t c) override { bytes.push_back(c); return 1; }
+  using Print::write;
+  int availableForWrite() override { return room; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+
+  std::vector<uint8_t> bytes;
+  int room = 64;
+};
+
+int main() {
+  sim::reset();
+  sim::advanceMs(1000);
+  CaptureStream out;
+  Telemetry telemetry(out, 20);
+
+  const uint8_t payload[3] = { 0x10, 0x20, 0x30 };
+  CHECK(telemetry.send(2, payload, sizeof(payload)));
+  CHECK(out.bytes.size() == 7);
+  CHECK(out.bytes[0] == TELEMETRY_SYNC);
+  CHECK(out.bytes[1] == 2);
+  CHECK(out.bytes[2] == 3);
+  CHECK(out.bytes[3] == 0x10 && out.bytes[4] == 0x20 && out.bytes[5] == 0x30);
+  CHECK(out.bytes[6] == (2 ^ 3 ^ 0x10 ^ 0x20 ^ 0x30));
+
+  // Rate limited per channel; other channels are independent
+  CHECK(!telemetry.send(2, payload, sizeof(payload)));
+  CHECK(telemetry.send(3, payload, sizeof(payload)));
+  sim::advanceMs(20);
+  CHECK(telemetry.send(2, payload, sizeof(payload)));
+
+  // No room in the TX buffer: dropped and counted, nothing written
+  sim::advanceMs(20);
+  out.room = 6;
+  size_t written = out.bytes.size();
+  CHECK(!telemetry.send(2, payload, sizeof(payload)));
+  CHECK(telemetry.dropped() == 1);
+  CHECK(out.bytes.size() == written);
+
+  // Out-of-range channel or payload
+  out.room = 64;
+  CHECK(!telemetry.send(TELEMETRY_CHANNELS, payload, 1));
+  CHECK(!telemetry.send(0, payload, TELEMETRY_MAX_PAYLOAD + 1));
+
+  return CHECK_RESULT();
+}
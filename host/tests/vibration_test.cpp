@@ -0,0 +1,81 @@
+// VibrationMotor against a full scheduler: the motor must never be left on
+// without a timer to turn it off
+
+#include <Arduino.h>
+#include "check.h"
+#include "config.h"
+#include "hostsim.h"
+#include "scheduler.h"
+#include "vibration.h"
+
+static void idle(void *) {}
+
+static void advance(unsigned long ms) {
+  for (unsigned long t = 0; t < ms; t++) {
+    sim::advanceMs(1);
+    scheduler.run();
+  }
+}
+
+static void pulseEndsLow() {
+  sim::reset();
+  VibrationMotor motor(Vibrationmotor_PIN);
+
+  motor.pulse(100);
+  CHECK(sim::pinLevel(Vibrationmotor_PIN) == HIGH);
+  advance(99);
+  CHECK(sim::pinLevel(Vibrationmotor_PIN) == HIGH);
+  advance(1);
+  CHECK(sim::pinLevel(Vibrationmotor_PIN) == LOW);
+}
+
+static void patternCountsPulses() {
+  sim::reset();
+  VibrationMotor motor(Vibrationmotor_PIN);
+
+  int rises = 0;
+  int level = LOW;
+  motor.pattern(20, 30, 3);
+  for (int t = 0; t < 500; t++) {
+    int now = sim::pinLevel(Vibrationmotor_PIN);
+    if (now == HIGH && level == LOW) rises++;
+    level = now;
+    advance(1);
+  }
+  CHECK(rises == 3);
+  CHECK(sim::pinLevel(Vibrationmotor_PIN) == LOW);
+}
+
+static void fullSchedulerSkipsPulse() {
+  sim::reset();
+  VibrationMotor motor(Vibrationmotor_PIN);
+
+  int ids[MAX_SCHEDULED_TASKS];
+  for (int i = 0; i < MAX_SCHEDULED_TASKS; i++) {
+    ids[i] = scheduler.after(1000, idle, nullptr);
+    CHECK(ids[i] >= 0);
+  }
+
+  motor.pulse(100);
+  CHECK(sim::pinLevel(Vibrationmotor_PIN) == LOW);
+  motor.pattern(20, 30, 3);
+  CHECK(sim::pinLevel(Vibrationmotor_PIN) == LOW);
+
+  // With a slot free again pulses work
+  scheduler.cancel(ids[0]);
+  motor.pulse(100);
+  CHECK(sim::pinLevel(Vibrationmotor_PIN) == HIGH);
+  advance(100);
+  CHECK(sim::pinLevel(Vibrationmotor_PIN) == LOW);
+
+  for (int i = 1; i < MAX_SCHEDULED_TASKS; i++) {
+    scheduler.cancel(ids[i]);
+  }
+}
+
+int main() {
+  pulseEndsLow();
+  patternCountsPulses();
+  fullSchedulerSkipsPulse();
+  return CHECK_RESULT();
+}